@@ -8,14 +8,23 @@
 #include "TextRenderer.h"
 #include "Camera.h"
 #include "OBJLoader.h"
+#include "ShaderProgram.h"
+#include "SpriteBatch.h"
+#include "DrawQueue.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "GLStats.h"
+#include "LatencyTracker.h"
+#include "Simulation.h"
+#include "InputRecording.h"
 
-struct Target {
+// Per-target data streamed to sphere3d.vert for instanced target rendering
+struct TargetInstance {
     glm::vec3 position;
     float radius;
-    float lifeTime;
-    float maxLifeTime;
-    bool active;
-    unsigned int texture;
+    float depth;
+    float lifeFraction;
+    float skin;
 };
 
 struct Button {
@@ -31,88 +40,94 @@ struct WallWeapon {
     bool isAK;
 };
 
-enum class FireMode {
-    USP,
-    AK47
+// Per-frame camera and light data, mirrors the std140 FrameUniforms block
+// declared in room, sphere3d and light shaders
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec3 viewPos;
+    float time;
+    glm::vec3 lightPos;
+    float lightIntensity;
+    glm::vec3 lightColor;
+    float padding;
 };
 
 class AimTrainer {
 private:
-    unsigned int rectShaderProgram;
-    unsigned int textureShaderProgram;
-    unsigned int freetypeShaderProgram;
-    unsigned int cylinderShaderProgram;
-    unsigned int roomShaderProgram;
-    unsigned int lightShaderProgram;
-    unsigned int weaponShaderProgram;
+    ShaderRegistry shaderRegistry;
+    ShaderProgram* spriteShaderProgram;
+    ShaderProgram* freetypeShaderProgram;
+    ShaderProgram* cylinderShaderProgram;
+    ShaderProgram* roomShaderProgram;
+    ShaderProgram* lightShaderProgram;
+    ShaderProgram* weaponShaderProgram;
     unsigned int VAO, VBO;
-    unsigned int textVAO, textVBO;
-    unsigned int textureVAO, textureVBO;
     unsigned int cylinderVAO, cylinderVBO, cylinderEBO;
+    unsigned int targetInstanceVBO;
     unsigned int roomVAO, roomVBO, roomEBO;
+    glm::vec3 roomFaceCenters[6];
     unsigned int lightVAO, lightVBO, lightEBO;
-    unsigned int studentInfoTexture;
-    unsigned int terroristTexture;
-    unsigned int counterTexture;
-    unsigned int heartTexture;
-    unsigned int emptyHeartTexture;
-    unsigned int akTexture;
-    unsigned int uspTexture;
+    unsigned int frameUBO;
+    unsigned int targetSkinArray;  // GL_TEXTURE_2D_ARRAY: terrorist, counter
     unsigned int wallTexture;
     unsigned int floorTexture;
     unsigned int ceilingTexture;
     TextRenderer* textRenderer;
-    Camera* camera;
+    SpriteBatch* spriteBatch;
+    DrawQueue drawQueue;
+    GpuProfiler* gpuProfiler;
+    int studentInfoImage;  // HUD images, ids in the spriteBatch atlas
+    int heartImage;
+    int emptyHeartImage;
+    int akImage;
+    int uspImage;
+    ManualClock clock;      // game time; only Frame input events move it, so recordings replay exactly
+    Simulation simulation;  // game rules; everything here is presentation
 
-    std::vector<Target> targets;
+    std::vector<TargetInstance> targetInstances;
+    size_t targetInstanceCapacity;
     std::vector<WallWeapon> wallWeapons;
     Button restartButton;
     Button exitButton;
-    int score;
-    int lives;
-    int maxLives;
-    double startTime;
-    double lastHitTime;
-    double totalHitTime;
-    int hitCount;
-    bool gameOver;
-    float spawnTimer;
-    float spawnInterval;
-    float initialSpawnInterval;
-    float minSpawnInterval;
-    float targetLifeTimeMultiplier;
-    float minTargetLifeTime;
     int windowWidth;
     int windowHeight;
-    double gameOverTime;
-    double survivalTime;
-    double avgHitSpeed;
     bool exitRequested;
-    int totalClicks;
-    FireMode fireMode;
-    bool isMousePressed;
-    double lastShotTime;
-    double fireRate;
     bool depthTestEnabled;
     bool faceCullingEnabled;
     bool gameOverPrintedOnce;
+    bool profilerOverlayVisible;
+    double profilerRefreshTime;
+    std::vector<Profiler::ZoneStats> profilerStats;
+    double gpuAverages[static_cast<int>(GpuZone::Count)];
+    double gpuMaxima[static_cast<int>(GpuZone::Count)];
+    GLStats::Counters glCounters;
+    LatencyTracker latencyTracker;
+    bool latencyTracking;
+    LatencyTracker::Distribution latencyStats[LatencyTracker::StageCount];
     double lastRecoilTime;
     float recoilAmount;
     float recoilRecoverySpeed;
+    uint32_t recoilShotCount;  // simulation.getShotsFired() the crosshair has reacted to
 
     // PERFORMANCE OPTIMIZATION: Cached uniform locations
-    int rectProjLoc, rectColorLoc, rectAlphaLoc;
-    int textureProjLoc, textureAlphaLoc, textureTexLoc;
-    int cylinderModelLoc, cylinderViewLoc, cylinderProjLoc, cylinderLightPosLoc, cylinderViewPosLoc, cylinderTimeLoc, cylinderTexLoc;
-    int roomViewLoc, roomProjLoc, roomModelLoc, roomWallColorLoc, roomUseTextureLoc, roomLightPosLoc, roomViewPosLoc, roomTexLoc;
-    int lightModelLoc, lightViewLoc, lightProjLoc, lightColorLoc, lightIntensityLoc;
-    int weaponModelLoc, weaponViewLoc, weaponProjLoc, weaponLightPosLoc, weaponViewPosLoc, weaponTimeLoc, weaponTexLoc;
+    int cylinderInstancedLoc, cylinderSkinsLoc;
+    int roomModelLoc, roomWallColorLoc, roomUseTextureLoc, roomTexLoc;
+    int lightModelLoc;
+    int weaponModelLoc, weaponTexLoc, weaponInstancedLoc;
 
     // PERFORMANCE OPTIMIZATION: Cached projection matrix
     float orthoProjection[16];
 
     // PERFORMANCE OPTIMIZATION: Shared light position (const member instead of constexpr)
     const glm::vec3 lightPosition;
+    const glm::vec3 lightColor;
+    const float lightIntensity;
+
+    // PERFORMANCE OPTIMIZATION: Camera/light data uploaded once per frame (uniform block binding 0)
+    static const unsigned int FRAME_UNIFORMS_BINDING = 0;
+    FrameUniforms frameUniforms;
 
     void initBuffers();
     void initCylinder();
@@ -121,35 +136,44 @@ private:
     void initWallWeapons();
     void cacheUniformLocations();
     void updateProjectionMatrix();
-    void spawnTarget();
-    void updateDifficulty();
-    void drawCylinder3D(const glm::vec3& position, float radius, float depth, unsigned int texture);
+    void initFrameUniforms();
+    void updateFrameUniforms();
+    void drawTargets();
     void drawRoom();
     void drawLight();
     void drawWallWeapons();
-    void drawWeaponMesh(const WallWeapon& weapon);
-    void drawRect(float x, float y, float width, float height, float r, float g, float b, float alpha = 1.0f);
-    void drawTexture(float x, float y, float width, float height, unsigned int texture, float alpha = 1.0f);
+    void drawProfilerOverlay();
     bool isPointInRect(float px, float py, float rx, float ry, float rw, float rh);
-    bool raySphereIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
-                                const glm::vec3& sphereCenter, float sphereRadius);
-    bool rayAABBIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
-                              const glm::vec3& boxMin, const glm::vec3& boxMax);
+    void applyRecoil();
 
 public:
-    AimTrainer(int width, int height);
+    // seed: target placement; startNs: game clock at creation (Profiler::nowNs() clock).
+    // The same seed, start time and input events replay the same game
+    AimTrainer(int width, int height, uint64_t seed, uint64_t startNs);
     ~AimTrainer();
 
+    // Single entry point for recorded and live input: Frame, Tick and the handlers below
+    void applyInput(const InputEvent& event);
     void update(float deltaTime);
     void render();
-    void handleMouseClick(double mouseX, double mouseY);
-    void handleMousePress(double mouseX, double mouseY);
-    void handleMouseRelease();
+    // inputTimeNs: Profiler::nowNs() at the input callback, 0 when the shot has no input event (auto-fire)
+    void handleMouseClick(double mouseX, double mouseY, uint64_t inputTimeNs = 0);
+    void handleMousePress(double mouseX, double mouseY, uint64_t inputTimeNs = 0);
+    void handleMouseRelease(uint64_t inputTimeNs = 0);
     void setFireMode(FireMode mode);
+    // Game keys: 1/2 weapons, R restart, D/F/P debug toggles. Others are ignored
+    void handleKey(int key);
     void toggleDepthTest();
     void toggleFaceCulling();
-    void processMouseMovement(float xoffset, float yoffset);
+    void toggleProfilerOverlay();
+    // timeNs: when the motion happened (Profiler::nowNs() clock), 0 = now
+    void processMouseMovement(float xoffset, float yoffset, uint64_t timeNs = 0);
     void restart();
-    bool isGameOver() const { return gameOver; }
+    bool isGameOver() const { return simulation.isGameOver(); }
+    Simulation& getSimulation() { return simulation; }
+    GpuProfiler* getGpuProfiler() const { return gpuProfiler; }
+    LatencyTracker& getLatencyTracker() { return latencyTracker; }
+    // Off for replays: recorded input times say nothing about this run's latency
+    void setLatencyTracking(bool enabled) { latencyTracking = enabled; }
     bool shouldExit() const;
 };
@@ -45,11 +45,17 @@ public:
     glm::vec3 getFront() const { return front; }
     glm::vec3 getRight() const { return right; }
     glm::vec3 getUp() const { return up; }
+    float getYaw() const { return yaw; }
+    float getPitch() const { return pitch; }
     float getZoom() const { return zoom; }
+    float getMouseSensitivity() const { return mouseSensitivity; }
     
     // Za postavljanje kamere da gleda prema odre?enoj ta?ki
     void lookAt(const glm::vec3& target);
     
     // Za raycasting (3D picking)
     glm::vec3 getRayDirection(float mouseX, float mouseY, int screenWidth, int screenHeight) const;
+
+    // Front vector for the given angles (degrees), as updateCameraVectors computes it
+    static glm::vec3 frontFromAngles(float yaw, float pitch);
 };
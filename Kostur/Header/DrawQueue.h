@@ -0,0 +1,91 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "ShaderProgram.h"
+#include "GpuProfiler.h"
+
+// Passes run in this order. Every pass has a fixed raster state (see setPassState).
+enum class RenderPass : unsigned char {
+    Opaque,
+    OpaqueTwoSided,
+    Translucent,
+    Count
+};
+
+// One indexed draw. Uniforms that differ between draws of the same program are
+// limited to a model matrix and one int switch; everything else is set once.
+struct DrawCommand {
+    RenderPass pass;
+    ShaderProgram* program;
+    unsigned int vao;
+    GLenum textureTarget;
+    unsigned int textureUnit;
+    unsigned int texture;   // 0 = leave the unit alone
+    int indexCount;
+    unsigned int firstIndex;
+    int instanceCount;      // 0 = plain glDrawElements
+    int modelLoc;           // -1 = no model matrix
+    int intLoc;             // -1 = no switch uniform
+    int intValue;
+    int gpuZone;            // GpuZone index for GPU timing, -1 = not timed
+
+    DrawCommand()
+        : pass(RenderPass::Opaque), program(nullptr), vao(0), textureTarget(GL_TEXTURE_2D),
+        textureUnit(0), texture(0), indexCount(0), firstIndex(0), instanceCount(0),
+        modelLoc(-1), intLoc(-1), intValue(0), gpuZone(-1) {}
+};
+
+// Per-frame list of draw commands. Draw helpers push commands instead of calling GL.
+// submit() radix-sorts them by a 64-bit key and issues them in one place.
+//
+// Opaque passes sort by  pass | program | texture | VAO | depth. Draws that share
+// state end up next to each other, and within a group they run front to back for
+// early-Z. The translucent pass sorts by  pass | far-to-near depth | program | ...
+// so blending stays correct. GL names are truncated to their key field; a
+// collision only affects grouping, never correctness.
+class DrawQueue {
+public:
+    struct PassState {
+        bool depthTest;
+        bool cullFace;
+        bool blend;
+    };
+
+    static constexpr float MAX_SORT_DEPTH = 64.0f;  // distances beyond this share the last depth bucket
+
+private:
+    struct Record {
+        DrawCommand command;
+        int matrixIndex;
+    };
+
+    struct SortEntry {
+        uint64_t key;
+        uint32_t record;
+    };
+
+    std::vector<Record> records;
+    std::vector<glm::mat4> matrices;
+    std::vector<SortEntry> sortEntries;
+    std::vector<SortEntry> sortScratch;
+    PassState passStates[static_cast<int>(RenderPass::Count)];
+
+    static uint64_t makeKey(const DrawCommand& command, float depth);
+    void radixSort();
+
+public:
+    DrawQueue();
+
+    void setPassState(RenderPass pass, const PassState& state);
+
+    void clear();
+    // depth is the distance from the camera, used only for ordering
+    void push(const DrawCommand& command, float depth);
+    void push(const DrawCommand& command, float depth, const glm::mat4& model);
+    // Consecutive commands with the same gpuZone share one timer query
+    void submit(GpuProfiler* gpuProfiler = nullptr);
+
+    size_t size() const { return records.size(); }
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <GLFW/glfw3.h>
+#include <vector>
+
+enum class FrameMode {
+    Uncapped,  // no vsync, no waiting (benchmarking)
+    VSync,     // glfwSwapBuffers paces the loop
+    Capped     // sleep in glfwWaitEventsTimeout, spin the last stretch for precision
+};
+
+struct FramePacing {
+    double fps;
+    double meanMs;
+    double jitterMs;         // standard deviation of the frame interval
+    double maxDeviationMs;   // largest distance of one interval from the mean
+};
+
+// Paces the main loop and drives a fixed-timestep simulation independent of the
+// render rate. Per frame:
+//
+//     scheduler.waitForFrame();            // also polls events
+//     while (scheduler.consumeStep()) game->update(scheduler.getStep());
+//     game->render(); glfwSwapBuffers(window);
+class FrameScheduler {
+private:
+    static constexpr int PACING_SAMPLES = 240;
+    static const int MAX_STEPS_PER_FRAME = 8;  // after a long stall, drop time instead of catching up
+    static constexpr double SPIN_SECONDS = 0.002;  // wait timeouts overshoot by about a scheduler tick
+
+    FrameMode mode;
+    double framePeriod;  // Capped only
+    double step;
+    double accumulator;
+    double lastFrameTime;
+    double nextFrameTime;
+
+    std::vector<double> intervals;  // ring of recent frame intervals in seconds
+    int intervalCursor;
+    int intervalCount;
+
+public:
+    FrameScheduler(FrameMode mode, double targetFps, double simulationHz);
+
+    // Sets the swap interval for the mode; call once the context is current
+    void applySwapInterval() const;
+
+    void waitForFrame();
+    bool consumeStep();
+    float getStep() const { return static_cast<float>(step); }
+
+    FrameMode getMode() const { return mode; }
+    FramePacing getPacing() const;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+
+// Per-frame GL call counts. install() replaces GLEW's entry points for program
+// switches, glUniform*, glGetUniformLocation, buffer uploads and instanced draws
+// with counting wrappers, so every call is seen, including ones added later
+// outside the usual helpers. GL 1.1 functions (glDrawElements, glBindTexture)
+// are not loaded through GLEW, so their call sites count themselves through
+// countDraw / countTextureBind.
+//
+// Define KOSTUR_NO_GL_STATS to compile all of it out.
+class GLStats {
+public:
+    enum Counter {
+        DrawCalls,
+        Triangles,
+        UniformCalls,
+        UniformLookups,
+        UploadBytes,
+        TextureBinds,
+        ProgramSwitches,
+        CounterCount
+    };
+
+    struct Counters {
+        unsigned long long values[CounterCount];
+    };
+
+    // Call once after glewInit
+    static void install();
+    static bool isInstalled();
+
+#ifdef KOSTUR_NO_GL_STATS
+    static void countDraw(GLenum, GLsizei, GLsizei = 1) {}
+    static void countTextureBind() {}
+#else
+    static void countDraw(GLenum mode, GLsizei count, GLsizei instances = 1);
+    static void countTextureBind();
+#endif
+
+    // Closes the current frame; call once per frame from the main loop
+    static void endFrame();
+    // Starts the run totals over, e.g. after loading or warmup
+    static void resetRun();
+
+    static const Counters& lastFrame();
+    static long long runFrames();
+    static double runMean(Counter counter);
+    static unsigned long long runMax(Counter counter);
+
+    static const char* counterName(Counter counter);
+    static bool writeJson(const std::string& path);
+};
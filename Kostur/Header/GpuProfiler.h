@@ -0,0 +1,85 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Logical GPU passes timed by GpuProfiler. HUD rects and images go out in one
+// SpriteBatch draw, so they share the HudSprites pass.
+enum class GpuZone {
+    Room,
+    Light,
+    Weapons,
+    Targets,
+    HudSprites,
+    Text,
+    Count
+};
+
+// A pair of GL_TIMESTAMP queries around each pass. Each frame uses its own set of
+// query objects, and results are read FRAMES_IN_FLIGHT frames later, so the CPU
+// never waits for the GPU. begin() closes the running segment first, so passes
+// never overlap. A pass split into several segments gets one pair per segment,
+// and the segments are summed.
+class GpuProfiler {
+public:
+    static const int FRAMES_IN_FLIGHT = 4;
+    static const int MAX_SEGMENTS_PER_FRAME = 32;
+    static constexpr int HISTORY_FRAMES = 120;
+
+    // One timed segment in GPU clock nanoseconds (glGetInteger64v(GL_TIMESTAMP))
+    struct Segment {
+        GpuZone zone;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+private:
+    struct FrameQueries {
+        unsigned int ids[MAX_SEGMENTS_PER_FRAME * 2];  // start, end per segment
+        GpuZone zones[MAX_SEGMENTS_PER_FRAME];
+        int count;
+        bool pending;
+    };
+
+    FrameQueries frames[FRAMES_IN_FLIGHT];
+    int frameIndex;
+    bool queryActive;
+    int droppedFrames;  // results still not ready when their queries were reused
+
+    float history[static_cast<int>(GpuZone::Count)][HISTORY_FRAMES];
+    int historyCursor;
+    int historyCount;
+
+    bool recording;
+    std::vector<float> runSamples[static_cast<int>(GpuZone::Count)];
+    std::vector<Segment>* segmentSink;
+
+    void readBack(FrameQueries& frame);
+
+public:
+    GpuProfiler();
+    ~GpuProfiler();
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    void beginFrame();
+    void begin(GpuZone zone);
+    void end();
+    void endFrame();
+
+    // Over the last HISTORY_FRAMES frames that have results
+    double averageMs(GpuZone zone) const;
+    double maxMs(GpuZone zone) const;
+    int getDroppedFrames() const { return droppedFrames; }
+
+    // Keep every per-frame result for a run summary (writeJson / getRunSamples)
+    void setRecording(bool enabled) { recording = enabled; }
+    const std::vector<float>& getRunSamples(GpuZone zone) const { return runSamples[static_cast<int>(zone)]; }
+    bool writeJson(const std::string& path) const;
+
+    // While a sink is set, every segment read back is also appended to it
+    void setSegmentSink(std::vector<Segment>* sink) { segmentSink = sink; }
+
+    static const char* zoneName(GpuZone zone);
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Refers to a pooled object for as long as it lives. The generation changes
+// every time a slot is reused, so a handle to a destroyed object never finds
+// its slot's next occupant. Generation 0 is never handed out: {} is null.
+struct PoolHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    PoolHandle() : index(0), generation(0) {}
+    PoolHandle(uint32_t slotIndex, uint32_t slotGeneration) : index(slotIndex), generation(slotGeneration) {}
+
+    bool isNull() const { return generation == 0; }
+    bool operator==(const PoolHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const PoolHandle& other) const { return !(*this == other); }
+};
+
+// Maps handles to positions in densely packed storage, which the owner keeps
+// packed with swap-remove. Capacity is fixed at construction: allocate() and
+// releaseAt() are O(1), take slots from a free list and never allocate memory.
+class HandleTable {
+private:
+    struct Slot {
+        uint32_t generation;
+        int link;  // in use: position in the owner's storage, free: next free slot
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> denseToSlot;
+    int freeHead;
+    int count;
+
+public:
+    explicit HandleTable(int capacity);
+
+    // Null when full; otherwise the new object is at dense position size() - 1
+    PoolHandle allocate();
+    // Frees the object at denseIndex; the last one moves there, as in the owner's swap-remove
+    void releaseAt(int denseIndex);
+    void clear();
+
+    // -1 for null and stale handles
+    int indexOf(PoolHandle handle) const {
+        if (handle.isNull() || handle.index >= slots.size() || slots[handle.index].generation != handle.generation) {
+            return -1;
+        }
+        return slots[handle.index].link;
+    }
+    PoolHandle handleAt(int denseIndex) const {
+        uint32_t slot = denseToSlot[denseIndex];
+        return PoolHandle(slot, slots[slot].generation);
+    }
+
+    int size() const { return count; }
+    int capacity() const { return static_cast<int>(slots.size()); }
+    bool full() const { return freeHead < 0; }
+};
+
+// Fixed-capacity pool of T kept contiguous for iteration, addressed by handle
+template <typename T>
+class HandlePool {
+private:
+    HandleTable table;
+    std::vector<T> items;
+
+public:
+    explicit HandlePool(int capacity) : table(capacity) { items.reserve(capacity); }
+
+    PoolHandle create(const T& item) {
+        PoolHandle handle = table.allocate();
+        if (!handle.isNull()) {
+            items.push_back(item);
+        }
+        return handle;
+    }
+
+    void destroy(PoolHandle handle) {
+        int index = table.indexOf(handle);
+        if (index >= 0) {
+            destroyAt(index);
+        }
+    }
+
+    void destroyAt(int index) {
+        table.releaseAt(index);
+        items[index] = items.back();
+        items.pop_back();
+    }
+
+    void clear() {
+        table.clear();
+        items.clear();
+    }
+
+    T* get(PoolHandle handle) {
+        int index = table.indexOf(handle);
+        return index >= 0 ? &items[index] : nullptr;
+    }
+    const T* get(PoolHandle handle) const {
+        int index = table.indexOf(handle);
+        return index >= 0 ? &items[index] : nullptr;
+    }
+
+    // Dense access; indices change when something is destroyed, handles do not
+    T& at(int index) { return items[index]; }
+    const T& at(int index) const { return items[index]; }
+    PoolHandle handleAt(int index) const { return table.handleAt(index); }
+
+    int size() const { return table.size(); }
+    int capacity() const { return table.capacity(); }
+    bool full() const { return table.full(); }
+    bool empty() const { return items.empty(); }
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Everything that drives the game, in the order the game saw it. Frame sets the
+// clock the simulation reads until the next Frame; Tick is one update(dt).
+// Timestamps are on the Profiler::nowNs() clock of the recording session.
+struct InputEvent {
+    enum Type : uint8_t {
+        Frame,
+        Motion,
+        ButtonDown,
+        ButtonUp,
+        Key,
+        Tick,
+        TypeCount
+    };
+
+    Type type;
+    uint64_t timeNs;   // all types except Tick
+    float x, y;        // Motion: offsets, ButtonDown: cursor position
+    int key;           // Key: GLFW key code
+    float deltaTime;   // Tick
+
+    static InputEvent frame(uint64_t timeNs) { return { Frame, timeNs, 0.0f, 0.0f, 0, 0.0f }; }
+    static InputEvent motion(uint64_t timeNs, float dx, float dy) { return { Motion, timeNs, dx, dy, 0, 0.0f }; }
+    static InputEvent buttonDown(uint64_t timeNs, float x, float y) { return { ButtonDown, timeNs, x, y, 0, 0.0f }; }
+    static InputEvent buttonUp(uint64_t timeNs) { return { ButtonUp, timeNs, 0.0f, 0.0f, 0, 0.0f }; }
+    static InputEvent keyPress(uint64_t timeNs, int key) { return { Key, timeNs, 0.0f, 0.0f, key, 0.0f }; }
+    static InputEvent tick(float deltaTime) { return { Tick, 0, 0.0f, 0.0f, 0, deltaTime }; }
+};
+
+// Binary recording: "KREC", format version, seed and start time, then one
+// record per event: a type byte, the time as a zigzag varint delta from the
+// previous timestamp (input can be older than the frame it arrives in), then
+// the payload. A mouse report at 1 kHz costs about 12 bytes.
+class InputRecorder {
+private:
+    FILE* file;
+    uint64_t lastTimeNs;
+    uint64_t eventCount;
+
+    void writeVarint(uint64_t value);
+
+public:
+    InputRecorder() : file(nullptr), lastTimeNs(0), eventCount(0) {}
+    ~InputRecorder() { finish(); }
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    // startNs: the game clock when the game was created
+    bool start(const std::string& path, uint64_t seed, uint64_t startNs);
+    void record(const InputEvent& event);  // no-op when not recording
+    void finish();
+
+    bool isRecording() const { return file != nullptr; }
+    uint64_t getEventCount() const { return eventCount; }
+};
+
+// Reads a recording back one event at a time
+class InputPlayer {
+private:
+    std::vector<unsigned char> data;
+    size_t cursor;
+    uint64_t seed;
+    uint64_t startNs;
+    uint64_t lastTimeNs;
+    InputEvent upcoming;
+    bool hasUpcoming;
+
+    bool readVarint(uint64_t& value);
+    bool readFloat(float& value);
+    bool decode(InputEvent& event);
+
+public:
+    InputPlayer() : cursor(0), seed(0), startNs(0), lastTimeNs(0), hasUpcoming(false) {}
+
+    bool open(const std::string& path);
+    bool isOpen() const { return !data.empty(); }
+    uint64_t getSeed() const { return seed; }
+    uint64_t getStartNs() const { return startNs; }
+
+    // nullptr at the end of the recording (or at the first damaged record)
+    const InputEvent* peek() const { return hasUpcoming ? &upcoming : nullptr; }
+    bool next(InputEvent& event);
+    // The next Frame event and everything up to the following one. False at the end
+    bool readFrame(std::vector<InputEvent>& events);
+};
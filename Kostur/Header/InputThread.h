@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "SpscQueue.h"
+
+// One raw mouse report: relative motion in device counts, or a left button change.
+// timeNs is on the Profiler::nowNs() clock.
+struct MouseSample {
+    enum Type : uint8_t {
+        Motion,
+        ButtonDown,
+        ButtonUp
+    };
+
+    uint64_t timeNs;
+    float dx;
+    float dy;  // positive = up, same as the GLFW callback offsets
+    Type type;
+};
+
+// Reads the mouse on its own thread and queues every report with its time, so
+// nothing is coalesced into one delta per frame and motion is not delayed until
+// the frame loop polls events. Backends: Raw Input through a message-only
+// window on Windows, evdev on Linux (needs read access to /dev/input/event*).
+// start() returns false when no backend is available; the caller then keeps
+// using the GLFW callbacks.
+class InputThread {
+public:
+    static const uint32_t QUEUE_SIZE = 16384;  // two seconds at 8 kHz
+
+private:
+    SpscQueue<MouseSample, QUEUE_SIZE> queue;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<uint32_t> droppedSamples;
+    const char* backend;
+
+#ifdef _WIN32
+    std::atomic<void*> messageWindow;  // HWND, set by the input thread
+#else
+    static const int MAX_DEVICES = 16;
+    int wakePipe[2];
+    int deviceFds[MAX_DEVICES];
+    bool deviceMonotonic[MAX_DEVICES];  // event times already on the steady clock
+    int deviceCount;
+#endif
+
+    void run();
+    void push(const MouseSample& sample);
+
+public:
+    InputThread();
+    ~InputThread();
+    InputThread(const InputThread&) = delete;
+    InputThread& operator=(const InputThread&) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+    const char* getBackend() const { return backend; }
+
+    // Consumer side; call from the main thread only
+    bool pop(MouseSample& sample) { return queue.pop(sample); }
+    uint32_t getDroppedSamples() const { return droppedSamples.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+
+// Click latency, measured from the moment the mouse callback ran:
+//   Hit     - the shot has been tested against the targets
+//   Submit  - the first frame rendered after that has been submitted
+//   Swap    - glfwSwapBuffers returned for that frame
+//   Present - a fence placed after the swap has signaled, so the GPU is done
+// Fences are polled without waiting, so Present is as precise as the polling
+// (once after the frame wait and once after each swap).
+class LatencyTracker {
+public:
+    enum Stage {
+        Hit,
+        Submit,
+        Swap,
+        Present,
+        StageCount
+    };
+
+    struct Distribution {
+        int samples;
+        double p50Ms, p90Ms, p99Ms, maxMs;
+    };
+
+    static const int MAX_CLICKS_PER_FRAME = 16;
+    static const int MAX_FENCED_FRAMES = 8;
+    static constexpr int HISTORY = 512;
+
+private:
+    struct FrameClicks {
+        uint64_t inputNs[MAX_CLICKS_PER_FRAME];
+        int count;
+    };
+
+    struct FencedFrame {
+        GLsync fence;
+        FrameClicks clicks;
+    };
+
+    FrameClicks resolved;   // waiting for the next render
+    FrameClicks submitted;  // rendered, waiting for the swap
+    FencedFrame fenced[MAX_FENCED_FRAMES];
+    int fencedHead;
+    int fencedCount;
+    int droppedClicks;
+
+    float history[StageCount][HISTORY];
+    int historyCursor[StageCount];
+    int historyCount[StageCount];
+
+    void addSample(Stage stage, uint64_t inputNs, uint64_t nowNs);
+
+public:
+    LatencyTracker();
+    ~LatencyTracker();
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    // inputNs is a Profiler::nowNs() timestamp taken in the input callback
+    void clickResolved(uint64_t inputNs);
+    // Call after render() and after the buffer swap
+    void frameSubmitted();
+    void frameSwapped();
+    // Checks pending fences without blocking
+    void poll();
+
+    // Over the last HISTORY samples of the stage
+    Distribution distribution(Stage stage) const;
+    int getDroppedClicks() const { return droppedClicks; }
+
+    static const char* stageName(Stage stage);
+};
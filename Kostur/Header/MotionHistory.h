@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+// Camera yaw/pitch after each mouse report, so a click can be tested against the
+// aim it had at its own timestamp instead of the aim when the frame loop gets to
+// it. Times are Profiler::nowNs() values and must be recorded in order.
+class MotionHistory {
+public:
+    static const int CAPACITY = 4096;  // half a second at 8 kHz
+
+private:
+    struct Entry {
+        uint64_t timeNs;
+        float yaw;
+        float pitch;
+    };
+
+    Entry entries[CAPACITY];
+    int head;   // next slot to write
+    int count;
+
+    const Entry& at(int index) const { return entries[(head - count + index + CAPACITY) % CAPACITY]; }
+
+public:
+    MotionHistory() : head(0), count(0) {}
+
+    void record(uint64_t timeNs, float yaw, float pitch);
+    void clear() { head = 0; count = 0; }
+
+    // Orientation after the last report at or before timeNs. False when the
+    // history is empty or timeNs is older than everything in it.
+    bool orientationAt(uint64_t timeNs, float& yaw, float& pitch) const;
+};
@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
+#include "RenderState.h"
 
 struct OBJMesh {
     unsigned int VAO;
@@ -15,7 +16,7 @@ struct OBJMesh {
     std::vector<unsigned int> indices;
     
     void cleanup() {
-        if (VAO) glDeleteVertexArrays(1, &VAO);
+        if (VAO) RenderState::deleteVertexArrays(1, &VAO);
         if (VBO) glDeleteBuffers(1, &VBO);
         if (EBO) glDeleteBuffers(1, &EBO);
     }
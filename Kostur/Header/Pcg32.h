@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+// PCG32 (pcg-random.org): 64-bit state, 32-bit output. Fast, tiny, and the same
+// sequence on every platform and library for a given seed, which rand() is not.
+class Pcg32 {
+private:
+    uint64_t state;
+    uint64_t increment;  // selects the stream, always odd
+
+public:
+    explicit Pcg32(uint64_t seedValue = 0, uint64_t stream = 0xda3e39cb94b95bdbULL) { seed(seedValue, stream); }
+
+    void seed(uint64_t seedValue, uint64_t stream = 0xda3e39cb94b95bdbULL) {
+        state = 0;
+        increment = (stream << 1) | 1;
+        next();
+        state += seedValue;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    // [0, bound), by multiply-shift instead of modulo
+    uint32_t nextBelow(uint32_t bound) { return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 32); }
+    // [0, 1) with 24 random bits, every value exactly representable
+    float nextFloat() { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+    // [-1, 1)
+    float nextSigned() { return nextFloat() * 2.0f - 1.0f; }
+
+    uint64_t getState() const { return state; }
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Scoped CPU timing. PROFILE_ZONE("name") times the rest of the enclosing block.
+// Each thread writes its events into its own ring; the ring is single-producer,
+// single-consumer, so writers never take a lock. Once per frame Profiler::endFrame()
+// drains the rings and adds up each zone's time for that frame. Stats cover the
+// last HISTORY_FRAMES frames.
+//
+// Zone names must be string literals (or otherwise outlive the profiler).
+class Profiler {
+public:
+    static constexpr int HISTORY_FRAMES = 240;
+    static const int MAX_ZONES = 32;
+
+    struct ZoneStats {
+        const char* name;
+        double minMs, avgMs, p99Ms;  // per-frame totals, so a zone hit N times in a frame counts once
+        double callsPerFrame;
+    };
+
+    struct Event {
+        const char* name;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+    struct ThreadEvent {
+        Event event;
+        int thread;  // 0 = first thread that recorded a zone
+    };
+
+    static uint64_t nowNs();
+    static void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    // Closes the current frame; call once per frame from the main loop
+    static void endFrame();
+
+    // Zones seen in the history window, in first-seen order
+    static void collect(std::vector<ZoneStats>& out);
+    static uint64_t droppedEvents();
+
+    // While a sink is set, endFrame also appends every event it drains to it
+    static void setEventSink(std::vector<ThreadEvent>* sink);
+};
+
+class ProfileZone {
+private:
+    const char* name;
+    uint64_t startNs;
+
+public:
+    explicit ProfileZone(const char* zoneName) : name(zoneName), startNs(Profiler::nowNs()) {}
+    ~ProfileZone() { Profiler::record(name, startNs, Profiler::nowNs()); }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef KOSTUR_NO_PROFILER
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#endif
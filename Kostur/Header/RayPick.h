@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <glm/glm.hpp>
+#include "TargetPool.h"
+
+// Nearest target along a ray, 8 (AVX2) or 4 (SSE2) targets per step. Targets
+// are drawn as discs turned towards the camera, so Disc tests exactly what the
+// player sees when the ray starts at the camera; Sphere is the old hitbox.
+// Only hits in front of the origin count (t > 0), and ties go to the lower
+// index, so the vector and scalar paths agree bit for bit. That also needs
+// RayPick.cpp built without FP contraction (see CMakeLists.txt, Kostur.vcxproj).
+class RayPick {
+public:
+    enum class Shape {
+        Disc,   // facing the ray origin
+        Sphere
+    };
+
+    struct Hit {
+        int index;  // -1: nothing hit
+        float t;    // distance along the normalized direction
+    };
+
+    static const uint64_t ANY_SPAWN_TIME = std::numeric_limits<uint64_t>::max();
+
+    // Targets spawned after maxSpawnNs are skipped (they were not there when the shot was fired)
+    static Hit nearest(const TargetPool& targets, const glm::vec3& origin, const glm::vec3& direction,
+                       Shape shape, uint64_t maxSpawnNs = ANY_SPAWN_TIME);
+    // Same result, one target at a time; the reference for tests and benchmarks
+    static Hit nearestScalar(const TargetPool& targets, const glm::vec3& origin, const glm::vec3& direction,
+                             Shape shape, uint64_t maxSpawnNs = ANY_SPAWN_TIME);
+    // Same result, testing only the targets the pool's TargetGrid puts near the ray
+    // (small pools fall back to nearest())
+    static Hit nearestIndexed(const TargetPool& targets, const glm::vec3& origin, const glm::vec3& direction,
+                              Shape shape, uint64_t maxSpawnNs = ANY_SPAWN_TIME);
+    // Several rays from one origin in a single pass over the targets. maxSpawnNs may be nullptr
+    static void nearestMany(const TargetPool& targets, const glm::vec3& origin, const glm::vec3* directions,
+                            const uint64_t* maxSpawnNs, int rayCount, Shape shape, Hit* hits);
+
+    // One target, for hitboxes kept outside the pool
+    static bool intersect(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& center,
+                          float radius, Shape shape, float& t);
+};
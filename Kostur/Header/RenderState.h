@@ -0,0 +1,43 @@
+#pragma once
+#include <GL/glew.h>
+
+// Shadow copy of the GL state the renderer touches: bound program, VAO,
+// textures per unit, enable bits, blend/depth/cull functions. Every draw path
+// sets state through here, and calls that would not change anything are
+// dropped before they reach the driver. Each draw helper states what it
+// needs instead of restoring what it changed.
+//
+// Objects must be deleted through the delete* helpers. Otherwise a recycled
+// GL name could match a stale cache entry and its bind would be skipped.
+class RenderState {
+public:
+    static const int MAX_TEXTURE_UNITS = 4;
+
+    struct Stats {
+        unsigned int issued;  // calls that reached GL
+        unsigned int elided;  // calls dropped as no-ops
+    };
+
+    // Marks everything unknown, so the next call of each kind is always issued.
+    // Needed after a new context or after code that calls GL directly.
+    static void reset();
+
+    static void beginFrame();
+    static Stats frameStats();
+
+    static void useProgram(unsigned int program);
+    static void bindVertexArray(unsigned int vao);
+    // Only GL_TEXTURE_2D and GL_TEXTURE_2D_ARRAY are tracked
+    static void bindTexture(unsigned int unit, GLenum target, unsigned int texture);
+
+    // Only GL_DEPTH_TEST, GL_CULL_FACE and GL_BLEND are tracked
+    static void setEnabled(GLenum capability, bool enabled);
+    static void blendFunc(GLenum source, GLenum destination);
+    static void depthFunc(GLenum func);
+    static void cullFace(GLenum face);
+    static void frontFace(GLenum mode);
+
+    static void deleteProgram(unsigned int program);
+    static void deleteVertexArrays(int count, const unsigned int* vaos);
+    static void deleteTextures(int count, const unsigned int* textures);
+};
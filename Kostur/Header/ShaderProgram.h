@@ -0,0 +1,59 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Linked shader program whose active uniforms are reflected once after linking.
+// Locations come from that table instead of glGetUniformLocation, and the
+// setters skip the GL call when the program already holds the same value.
+// Setters expect the program to be bound (glUniform* writes the current program).
+class ShaderProgram {
+private:
+    struct Uniform {
+        std::string name;
+        int location;
+        GLenum type;
+        int valueCount;
+        bool hasValue;
+        float value[16];
+    };
+
+    unsigned int id;
+    std::vector<Uniform> uniforms;          // sorted by name
+    std::vector<int> uniformIndexByLocation;  // location -> index into uniforms, -1 if unknown
+
+    void reflectUniforms();
+    bool updateCache(int location, const void* data, int valueCount);
+
+public:
+    ShaderProgram(const char* vsSource, const char* fsSource);
+    ~ShaderProgram();
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    unsigned int getId() const { return id; }
+    void use() const;
+    int getUniformLocation(const char* name) const;
+    void bindUniformBlock(const char* blockName, unsigned int bindingPoint) const;
+
+    void setInt(int location, int value);
+    void setFloat(int location, float value);
+    void setVec3(int location, float x, float y, float z);
+    void setVec3(int location, const glm::vec3& value);
+    void setMat4(int location, const float* value);
+    void setMat4(int location, const glm::mat4& value);
+};
+
+// Owns every ShaderProgram and hands out the same program for the same
+// vertex/fragment pair, so e.g. targets and wall weapons share one link.
+class ShaderRegistry {
+private:
+    std::map<std::string, std::unique_ptr<ShaderProgram>> programs;
+
+public:
+    ShaderProgram* acquire(const char* vsSource, const char* fsSource);
+    size_t size() const { return programs.size(); }
+};
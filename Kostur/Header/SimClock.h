@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+// Time source for Simulation. Input timestamps handed to the simulation must be
+// on the same clock.
+class SimClock {
+public:
+    virtual ~SimClock() {}
+    virtual uint64_t nowNs() const = 0;
+};
+
+// Moves only when told to, so a run repeats exactly. Starts above 0 because a
+// 0 timestamp means "no input time" throughout the game.
+class ManualClock : public SimClock {
+private:
+    uint64_t timeNs;
+
+public:
+    explicit ManualClock(uint64_t startNs = 1000000000ull) : timeNs(startNs) {}
+    uint64_t nowNs() const override { return timeNs; }
+    void advance(uint64_t ns) { timeNs += ns; }
+    void set(uint64_t ns) { timeNs = ns; }
+};
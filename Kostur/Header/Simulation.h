@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.h"
+#include "MotionHistory.h"
+#include "Pcg32.h"
+#include "RayPick.h"
+#include "SimClock.h"
+#include "SpawnSampler.h"
+#include "TargetPool.h"
+
+// A target that ran out recently, kept so a click made before it ran out still counts
+struct ExpiredTarget {
+    TargetHandle target;  // no longer valid, but identifies the target that ran out
+    glm::vec3 position;
+    float radius;
+    uint64_t spawnTimeNs;
+    uint64_t expiredAtNs;
+};
+
+// Wall-mounted weapon as the game rules see it: shooting the box switches weapons
+struct WeaponPickup {
+    glm::vec3 position;
+    glm::vec3 scale;  // model scale, the hitbox is a small fraction of it
+    bool isAK;
+};
+
+enum class FireMode {
+    USP,
+    AK47
+};
+
+// Game rules without any OpenGL: targets, difficulty, lives, score, weapons and
+// the camera the player aims with. Time comes only from tick() and the injected
+// clock, randomness only from a seeded Pcg32, so the same seed, clock readings
+// and input give bit-identical results (see stateHash()).
+class Simulation {
+public:
+    enum class ShotResult {
+        Miss,
+        Hit,
+        Pickup  // hit a wall weapon; not counted as a shot
+    };
+
+    struct Shot {
+        uint64_t timeNs;
+        glm::vec3 direction;
+    };
+
+    static const int MAX_SHOTS_PER_TICK = 16;
+    static const int MAX_TARGETS = 256;  // more than SpawnSampler can place at once
+    // The room AimTrainer::initRoom() draws, 20 x 10 x 20; spawns and the target grid share it
+    static constexpr float ROOM_HALF_WIDTH = 10.0f;
+    static constexpr float ROOM_HALF_HEIGHT = 5.0f;
+    static constexpr float ROOM_HALF_DEPTH = 10.0f;
+
+private:
+    const SimClock& clock;
+    Pcg32 random;
+    bool loggingEnabled;
+
+    Camera camera;
+    MotionHistory motionHistory;
+    TargetPool targets;
+    // Removed once refunded; when full, the oldest makes room
+    static const int EXPIRED_HISTORY = 16;
+    HandlePool<ExpiredTarget> recentlyExpired;
+    std::vector<WeaponPickup> weaponPickups;
+    SpawnSampler spawnSampler;
+
+    int score;
+    int lives;
+    int maxLives;
+    int hitCount;
+    int totalClicks;
+    int lateHits;
+    uint64_t startNs;
+    uint64_t lastHitNs;
+    double totalHitTime;
+    double survivalTime;
+    double avgHitSpeed;
+    bool gameOver;
+    float spawnTimer;
+    float spawnInterval;
+    float initialSpawnInterval;
+    float minSpawnInterval;
+    float targetLifeTimeMultiplier;
+    float minTargetLifeTime;
+
+    FireMode fireMode;
+    bool triggerHeld;
+    double fireRate;
+    uint32_t shotsFired;
+    // Full-auto schedule in simulated seconds (the sum of tick() steps), so the
+    // cadence is fireRate whatever the frame or tick rate.
+    double simTime;
+    // Simulated seconds on the clock: timelineTime is at timelineNs and the rest
+    // follows at one second per second. Moved only when the simulation and the
+    // clock drift more than a step apart, i.e. when the frame loop dropped time.
+    double timelineTime;
+    uint64_t timelineNs;
+    uint64_t frameNs;     // clock reading the latest ticks ran under
+    uint64_t lastStepNs;
+    double triggerPressTime;
+    uint64_t triggerPressNs;
+    double triggerReleaseTime;
+    double nextShotTime;
+
+    bool spawnTarget();
+    void updateDifficulty();
+    void registerHit(uint64_t nowNs);
+    glm::vec3 aimAt(uint64_t timeNs) const;
+    void fireShots(const Shot* shots, int count, ShotResult* results);
+    double secondsSince(uint64_t timeNs) const;
+    uint64_t timelineNsAt(double time) const;
+    void syncTimeline();
+
+    static bool rayAABBIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+                                    const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+public:
+    Simulation(const SimClock& simClock, uint64_t seed);
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void restart();
+    void tick(float deltaTime);
+
+    // Input. timeNs is on the simulation clock, 0 = now
+    ShotResult click(uint64_t timeNs = 0);
+    void pressTrigger(uint64_t timeNs = 0);
+    void releaseTrigger(uint64_t timeNs = 0);
+    void look(float xoffset, float yoffset, uint64_t timeNs = 0);
+    void setFireMode(FireMode mode);
+
+    // Console messages for hits and weapon changes; off for headless runs
+    void setLogging(bool enabled) { loggingEnabled = enabled; }
+
+    bool isGameOver() const { return gameOver; }
+    const Camera& getCamera() const { return camera; }
+    const TargetPool& getTargets() const { return targets; }
+    const std::vector<WeaponPickup>& getWeaponPickups() const { return weaponPickups; }
+    FireMode getFireMode() const { return fireMode; }
+    int getScore() const { return score; }
+    int getLives() const { return lives; }
+    int getMaxLives() const { return maxLives; }
+    int getHitCount() const { return hitCount; }
+    int getTotalClicks() const { return totalClicks; }
+    // Hits on targets tick() had already expired, from shots fired before they ran out
+    int getLateHits() const { return lateHits; }
+    double getTotalHitTime() const { return totalHitTime; }
+    double getSurvivalTime() const { return survivalTime; }
+    double getAverageHitSpeed() const { return avgHitSpeed; }
+    double getElapsedTime() const { return secondsSince(startNs); }
+    // Grows by one per shot fired, wall pickups included; drives the crosshair recoil
+    uint32_t getShotsFired() const { return shotsFired; }
+
+    // FNV-1a over everything the rules depend on, for checking that two runs match
+    uint64_t stateHash() const;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.h"
+#include "Pcg32.h"
+#include "TargetPool.h"
+
+// Spawn positions from Poisson-disk point sets made once per wall, at least
+// two target radii apart, so points of one set never overlap each other. A
+// spawn picks uniformly among the points that are in view and not covered by
+// a live target (checked through the pool's grid): no retries, no failures
+// while anything in view is free, and the same cost at any spawn rate.
+class SpawnSampler {
+public:
+    static const int LAYOUTS_PER_WALL = 4;  // overlapping sets, for variety; the grid keeps them apart
+
+private:
+    std::vector<glm::vec3> points;
+    std::vector<int> candidates;  // kept between calls so sampling does not allocate
+    float radius;
+
+    // Bridson's algorithm on [-halfU, halfU] x [-halfV, halfV]
+    static void poissonDisk(float halfU, float halfV, float minDistance, Pcg32& random, std::vector<glm::vec2>& out);
+
+public:
+    // The room's half extents and the margin kept from the wall edges, as spawnTarget() used them
+    SpawnSampler(float halfWidth, float halfHeight, float halfDepth, float margin, float targetRadius, uint64_t seed);
+
+    // False when every point in view is taken
+    bool sample(const Camera& camera, const TargetPool& targets, Pcg32& random, glm::vec3& position);
+
+    float getRadius() const { return radius; }
+    int getPointCount() const { return static_cast<int>(points.size()); }
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include "ShaderProgram.h"
+
+// Collects colored and textured 2D quads and draws them with one glDrawElements per flush.
+// Images are packed into a single RGBA atlas at load time; colored quads sample a white
+// texel of the same atlas, so rects and images never force a texture or program switch.
+class SpriteBatch {
+private:
+    struct Vertex {
+        float x, y;
+        float u, v;
+        unsigned char r, g, b, a;
+    };
+
+    struct PendingImage {
+        int width, height;
+        unsigned char* pixels;
+    };
+
+    struct Region {
+        float u0, v0, u1, v1;
+    };
+
+    ShaderProgram* shaderProgram;
+    int projLoc, atlasLoc;
+    unsigned int VAO, VBO, EBO;
+    unsigned int atlasTexture;
+    int atlasWidth, atlasHeight;
+    float whiteU, whiteV;
+
+    std::vector<PendingImage> pendingImages;
+    std::vector<Region> regions;
+    std::vector<Vertex> vertices;
+    size_t quadCapacity;
+    float projection[16];
+
+    void pushQuad(float x, float y, float width, float height,
+                  float u0, float v0, float u1, float v1,
+                  float r, float g, float b, float alpha);
+    void reserveQuads(size_t quadCount);
+
+public:
+    SpriteBatch(ShaderProgram* shader);
+    ~SpriteBatch();
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+    // Queues an image for the atlas and returns its id, -1 if it could not be loaded.
+    // All images must be added before buildAtlas().
+    int addImage(const char* filePath);
+    bool buildAtlas();
+
+    void setProjection(const float* ortho);
+    void drawRect(float x, float y, float width, float height, float r, float g, float b, float alpha = 1.0f);
+    void drawImage(int image, float x, float y, float width, float height, float alpha = 1.0f);
+    void flush();
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Uniform 2D grid on each of the four walls targets spawn on, so a shot only
+// tests the targets in the cells its ray passes near. Holds TargetPool indices
+// and follows the pool's swap-remove, so every update is O(1). Targets away
+// from the walls go to one extra cell that every query visits.
+class TargetGrid {
+public:
+    static constexpr float WALL_INSET = 0.5f;  // target centers sit this far in front of a wall
+    static constexpr float WALL_TOLERANCE = 0.5f;
+    static constexpr float CELL_SIZE = 1.0f;
+    static const int WALL_COUNT = 4;
+
+private:
+    struct Wall {
+        int normalAxis;  // 0 = x, 2 = z
+        float offset;
+        int uAxis;
+        float halfU;     // half the wall's length along uAxis
+        int cellsU;
+        int firstCell;
+    };
+
+    Wall walls[WALL_COUNT];
+    float halfHeight;
+    int cellsV;
+    int looseCell;
+    float maxDistance;  // longer than any ray inside the room
+
+    std::vector<std::vector<int>> cells;
+    std::vector<int> cellOfTarget;  // by pool index
+    std::vector<int> slotOfTarget;  // position inside its cell
+    float maxRadius;
+
+    static int clampCell(float coordinate, float half, int count) {
+        int cell = static_cast<int>(std::floor((coordinate + half) / CELL_SIZE));
+        return cell < 0 ? 0 : (cell >= count ? count - 1 : cell);
+    }
+
+    int cellAt(const Wall& wall, float u, float v) const {
+        return wall.firstCell + clampCell(v, halfHeight, cellsV) * wall.cellsU + clampCell(u, wall.halfU, wall.cellsU);
+    }
+
+    // Cells of one wall overlapping [uMin, uMax] x [vMin, vMax]
+    template <typename Visit>
+    void visitRange(const Wall& wall, float uMin, float uMax, float vMin, float vMax, Visit& visit) const {
+        int u0 = clampCell(uMin, wall.halfU, wall.cellsU);
+        int u1 = clampCell(uMax, wall.halfU, wall.cellsU);
+        int v0 = clampCell(vMin, halfHeight, cellsV);
+        int v1 = clampCell(vMax, halfHeight, cellsV);
+        for (int v = v0; v <= v1; v++) {
+            for (int u = u0; u <= u1; u++) {
+                for (int index : cells[wall.firstCell + v * wall.cellsU + u]) {
+                    visit(index);
+                }
+            }
+        }
+    }
+
+public:
+    // The room's half extents, the same ones SpawnSampler places targets in
+    TargetGrid(float roomHalfWidth, float roomHalfHeight, float roomHalfDepth);
+
+    void reserve(size_t capacity);
+    void clear();
+
+    // index must be the pool's new last index
+    void insert(int index, const glm::vec3& position, float radius);
+    // Mirrors TargetPool::remove(): last takes over index
+    void remove(int index, int last);
+
+    // Every target whose disc could be crossed by the ray, each once
+    template <typename Visit>
+    void forEachAlongRay(const glm::vec3& origin, const glm::vec3& direction, Visit visit) const {
+        for (const Wall& wall : walls) {
+            // Where the ray is inside the slab of possible target centers around the wall
+            float slabMin = wall.offset - WALL_TOLERANCE - maxRadius;
+            float slabMax = wall.offset + WALL_TOLERANCE + maxRadius;
+            float o = origin[wall.normalAxis];
+            float d = direction[wall.normalAxis];
+            float tEnter, tExit;
+            if (std::abs(d) < 1e-6f) {
+                if (o < slabMin || o > slabMax) continue;
+                tEnter = 0.0f;
+                tExit = maxDistance;
+            }
+            else {
+                tEnter = (slabMin - o) / d;
+                tExit = (slabMax - o) / d;
+                if (tEnter > tExit) std::swap(tEnter, tExit);
+                if (tExit < 0.0f) continue;
+                tEnter = std::max(tEnter, 0.0f);
+                tExit = std::min(tExit, maxDistance);
+                if (tEnter > tExit) continue;
+            }
+            glm::vec3 a = origin + direction * tEnter;
+            glm::vec3 b = origin + direction * tExit;
+            visitRange(wall, std::min(a[wall.uAxis], b[wall.uAxis]) - maxRadius, std::max(a[wall.uAxis], b[wall.uAxis]) + maxRadius,
+                std::min(a.y, b.y) - maxRadius, std::max(a.y, b.y) + maxRadius, visit);
+        }
+        for (int index : cells[looseCell]) {
+            visit(index);
+        }
+    }
+
+    // Every target whose center could be within radius + its own radius of position
+    template <typename Visit>
+    void forEachNear(const glm::vec3& position, float radius, Visit visit) const {
+        float reach = radius + maxRadius;
+        for (const Wall& wall : walls) {
+            if (std::abs(position[wall.normalAxis] - wall.offset) > reach + WALL_TOLERANCE) continue;
+            visitRange(wall, position[wall.uAxis] - reach, position[wall.uAxis] + reach,
+                position.y - reach, position.y + reach, visit);
+        }
+        for (int index : cells[looseCell]) {
+            visit(index);
+        }
+    }
+};
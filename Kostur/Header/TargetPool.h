@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "HandlePool.h"
+#include "TargetGrid.h"
+
+typedef PoolHandle TargetHandle;
+
+// Live targets as parallel arrays, so the per-tick lifetime pass touches only
+// the lifetimes and runs 8 (AVX2) or 4 (SSE2) targets per instruction. Indices
+// are dense: removing a target moves the last one into its slot, so an index
+// is only valid until the next removal. A TargetHandle stays valid for the
+// target's whole life. Capacity is fixed, so nothing allocates after construction.
+class TargetPool {
+private:
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> radii;
+    std::vector<float> lifeTimes;
+    std::vector<float> maxLifeTimes;
+    std::vector<int> skins;
+    std::vector<uint64_t> spawnTimes;
+    HandleTable handles;
+    TargetGrid grid;
+
+    // Bit i set: target i ran out in the last age() call
+    std::vector<uint64_t> expiredMask;
+
+public:
+    // The room's half extents size the pool's TargetGrid
+    TargetPool(int capacity, float roomHalfWidth, float roomHalfHeight, float roomHalfDepth);
+
+    void clear();
+
+    // Null when the pool is full; the new target is at index size() - 1
+    TargetHandle add(const glm::vec3& position, float radius, float lifeTime, int skin, uint64_t spawnTimeNs);
+    // Swap-remove: the last target takes over the index
+    void remove(int index);
+    // -1 once the target is gone
+    int indexOf(TargetHandle handle) const { return handles.indexOf(handle); }
+
+    // Lowers every lifetime by deltaTime and returns how many targets reached zero;
+    // those are set in getExpiredMask() and stay in the pool until removeExpired()
+    int age(float deltaTime);
+    const std::vector<uint64_t>& getExpiredMask() const { return expiredMask; }
+    bool isExpired(int index) const { return (expiredMask[index >> 6] >> (index & 63)) & 1; }
+    void removeExpired();
+
+    // True if a target of this radius at position would touch a live one
+    bool overlaps(const glm::vec3& position, float radius) const;
+    const TargetGrid& getGrid() const { return grid; }
+
+    int size() const { return static_cast<int>(lifeTimes.size()); }
+    int capacity() const { return handles.capacity(); }
+    bool full() const { return handles.full(); }
+    bool empty() const { return lifeTimes.empty(); }
+
+    // Whole columns, for kernels that test many targets at once
+    const float* getPositionX() const { return positionX.data(); }
+    const float* getPositionY() const { return positionY.data(); }
+    const float* getPositionZ() const { return positionZ.data(); }
+    const float* getRadii() const { return radii.data(); }
+    const uint64_t* getSpawnTimes() const { return spawnTimes.data(); }
+
+    glm::vec3 getPosition(int index) const { return glm::vec3(positionX[index], positionY[index], positionZ[index]); }
+    float getRadius(int index) const { return radii[index]; }
+    float getLifeTime(int index) const { return lifeTimes[index]; }
+    float getMaxLifeTime(int index) const { return maxLifeTimes[index]; }
+    int getSkin(int index) const { return skins[index]; }
+    uint64_t getSpawnTimeNs(int index) const { return spawnTimes[index]; }
+    TargetHandle getHandle(int index) const { return handles.handleAt(index); }
+};
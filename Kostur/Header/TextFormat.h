@@ -0,0 +1,67 @@
+#pragma once
+#include <charconv>
+#include <cstring>
+#include <system_error>
+
+// Fixed-capacity string builder for per-frame HUD text. Numbers go through
+// std::to_chars, so formatting never touches the heap or the stream locale.
+// Output that does not fit is truncated.
+template <int Capacity>
+class TextBuffer {
+private:
+    char chars[Capacity];
+    int length;
+
+public:
+    TextBuffer() : length(0) {}
+
+    void clear() { length = 0; }
+    const char* text() const { return chars; }  // not null-terminated, pair with size()
+    int size() const { return length; }
+
+    TextBuffer& append(const char* str) {
+        int count = static_cast<int>(std::strlen(str));
+        if (count > Capacity - length) {
+            count = Capacity - length;
+        }
+        std::memcpy(chars + length, str, count);
+        length += count;
+        return *this;
+    }
+
+    // Zero-padded to at least minDigits, like std::setfill('0') << std::setw(minDigits)
+    TextBuffer& appendInt(long long value, int minDigits = 1) {
+        // Magnitude as unsigned, so LLONG_MIN does not overflow
+        unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+        char digits[24] = {};
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), magnitude);
+        int count = result.ec == std::errc() ? static_cast<int>(result.ptr - digits) : 0;
+        if (value < 0 && length < Capacity) {
+            chars[length++] = '-';
+        }
+        for (int i = count; i < minDigits && length < Capacity; i++) {
+            chars[length++] = '0';
+        }
+        for (int i = 0; i < count && length < Capacity; i++) {
+            chars[length++] = digits[i];
+        }
+        return *this;
+    }
+
+    // Same output as std::fixed << std::setprecision(precision)
+    TextBuffer& appendFixed(double value, int precision) {
+        // Formatted whole first, so a value that does not fit is cut like any other text
+        char digits[400];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+        if (result.ec != std::errc()) {
+            return *this;
+        }
+        int count = static_cast<int>(result.ptr - digits);
+        if (count > Capacity - length) {
+            count = Capacity - length;
+        }
+        std::memcpy(chars + length, digits, count);
+        length += count;
+        return *this;
+    }
+};
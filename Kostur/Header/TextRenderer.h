@@ -3,30 +3,78 @@
 #include <GLFW/glfw3.h>
 #include <ft2build.h>
 #include FT_FREETYPE_H
-#include <map>
 #include <string>
+#include <vector>
+#include "ShaderProgram.h"
 
+// Glyph metrics plus its rectangle in the glyph atlas
 struct Character {
-    unsigned int TextureID;
+    float U0, V0, U1, V1;
     int SizeX, SizeY;
     int BearingX, BearingY;
     unsigned int Advance;
 };
 
+enum class TextAlign {
+    Left,
+    Center  // x is the horizontal center of the string
+};
+
+// All glyphs live in one GL_R8 atlas. renderText only appends quads to a batch,
+// flush() draws everything queued since the last flush with a single draw call.
 class TextRenderer {
 private:
-    std::map<char, Character> Characters;
-    unsigned int VAO, VBO;
-    unsigned int shaderProgram;
+    struct Vertex {
+        float x, y;
+        float u, v;
+        unsigned char r, g, b, a;
+    };
+
+    Character Characters[256];
+    unsigned int VAO, VBO, EBO;
+    unsigned int atlasTexture;
+    ShaderProgram* shaderProgram;
+    int projLoc, atlasLoc;
     FT_Library ft;
     FT_Face face;
     int windowWidth, windowHeight;
+    float projection[16];
+
+    static const int MAX_LAYOUT_CHARS = 48;
+    static const int LAYOUT_SLOTS = 64;
+
+    // Measured string with its glyph quads already built. Reused as long as text, scale,
+    // position, alignment and color match; the least recently used slot is rebuilt otherwise.
+    struct TextLayout {
+        char text[MAX_LAYOUT_CHARS];
+        int length;
+        float x, y, scale;
+        TextAlign align;
+        unsigned char color[4];
+        float width;
+        int quadCount;
+        Vertex quads[MAX_LAYOUT_CHARS * 4];
+        unsigned int lastUsed;
+    };
+
+    std::vector<Vertex> vertices;
+    size_t quadCapacity;
+    TextLayout layouts[LAYOUT_SLOTS];
+    unsigned int layoutClock;
+
+    void reserveQuads(size_t quadCount);
+    float measure(const char* text, int length, float scale) const;
+    int buildQuads(const char* text, int length, float x, float y, float scale, const unsigned char color[4], Vertex* out) const;
+    const TextLayout& acquireLayout(const char* text, int length, float x, float y, float scale, TextAlign align, const unsigned char color[4]);
 
 public:
-    TextRenderer(unsigned int shader, int width, int height);
+    TextRenderer(ShaderProgram* shader, int width, int height);
     ~TextRenderer();
     
     bool loadFont(const char* fontPath, unsigned int fontSize);
     void renderText(const std::string& text, float x, float y, float scale, float r, float g, float b, float alpha = 1.0f);
+    void drawText(const char* text, int length, float x, float y, float scale, float r, float g, float b,
+                  float alpha = 1.0f, TextAlign align = TextAlign::Left);
+    void flush();
     float getTextWidth(const std::string& text, float scale);
 };
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Profiler.h"
+#include "GpuProfiler.h"
+
+// Records a fixed number of frames and writes them as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev). The trace has CPU zones per thread, a
+// GPU track with the GpuProfiler passes, input events as instant markers on the
+// main thread, and one span per frame.
+//
+// GPU results arrive FRAMES_IN_FLIGHT frames late, so after the last recorded
+// frame the capture keeps collecting them for a few more frames before it
+// writes the file. GPU times are moved onto the CPU clock with an offset
+// measured when the capture starts.
+class TraceCapture {
+private:
+    enum class State {
+        Idle,
+        Recording,
+        Draining
+    };
+
+    struct InputEvent {
+        const char* name;
+        uint64_t timeNs;
+        double x;
+        double y;
+    };
+
+    State state;
+    std::string path;
+    int framesLeft;
+    int drainFramesLeft;
+    uint64_t startNs;
+    int64_t gpuToCpuNs;
+    GpuProfiler* gpuProfiler;
+
+    std::vector<Profiler::ThreadEvent> cpuEvents;
+    std::vector<GpuProfiler::Segment> gpuSegments;
+    std::vector<InputEvent> inputEvents;
+    std::vector<uint64_t> frameEnds;
+
+    void stopSinks();
+    bool write() const;
+
+public:
+    TraceCapture();
+    ~TraceCapture();
+    TraceCapture(const TraceCapture&) = delete;
+    TraceCapture& operator=(const TraceCapture&) = delete;
+
+    // Starts recording the next frames; ignored while a capture is running
+    void start(const std::string& outputPath, int frames, GpuProfiler* profiler);
+    bool isActive() const { return state != State::Idle; }
+
+    // Instant marker on the main thread with a position or offset in its args.
+    // timeNs = 0 stamps the event now.
+    void recordInput(const char* name, double x, double y, uint64_t timeNs = 0) {
+        if (state == State::Recording) {
+            inputEvents.push_back({ name, timeNs != 0 ? timeNs : Profiler::nowNs(), x, y });
+        }
+    }
+
+    // Call once per frame, after Profiler::endFrame
+    void endFrame();
+    // Writes whatever has been captured so far (GPU passes of the last frames may be missing)
+    void finish();
+};
@@ -2,6 +2,8 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <string>
+#include <vector>
 int endProgram(std::string message);
 unsigned int createShader(const char* vsSource, const char* fsSource);
-unsigned loadImageToTexture(const char* filePath);
\ No newline at end of file
+unsigned loadImageToTexture(const char* filePath);
+unsigned loadImagesToTextureArray(const std::vector<std::string>& filePaths);
\ No newline at end of file
@@ -1,6 +1,8 @@
 #version 330 core
 layout (location = 0) in vec4 vertex;
+layout (location = 1) in vec4 aColor;
 out vec2 TexCoords;
+out vec4 TextColor;
 
 uniform mat4 uProjection;
 
@@ -8,4 +10,5 @@ void main()
 {
     gl_Position = uProjection * vec4(vertex.xy, 0.0, 1.0);
     TexCoords = vertex.zw;
+    TextColor = aColor;
 }
@@ -5,13 +5,21 @@ in vec3 Normal;
 
 out vec4 FragColor;
 
-uniform vec3 uLightColor;
-uniform float uIntensity;
+layout(std140) uniform FrameUniforms {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec3 uViewPos;
+    float uTime;
+    vec3 uLightPos;
+    float uLightIntensity;
+    vec3 uLightColor;
+};
 
 void main()
 {
     // Emissive material - lampa emituje svetlost
-    vec3 emission = uLightColor * uIntensity;
+    vec3 emission = uLightColor * uLightIntensity;
     
     // Dodaj blagi glow efekat na ivicama
     vec3 viewDir = normalize(-FragPos);
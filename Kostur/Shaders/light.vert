@@ -6,14 +6,23 @@ layout(location = 1) in vec3 aNormal;
 out vec3 FragPos;
 out vec3 Normal;
 
+layout(std140) uniform FrameUniforms {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec3 uViewPos;
+    float uTime;
+    vec3 uLightPos;
+    float uLightIntensity;
+    vec3 uLightColor;
+};
+
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
 
 void main()
 {
     FragPos = vec3(uModel * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(uModel))) * aNormal;
     
-    gl_Position = uProjection * uView * vec4(FragPos, 1.0);
+    gl_Position = uViewProjection * vec4(FragPos, 1.0);
 }
@@ -6,8 +6,17 @@ in vec2 TexCoords;
 
 out vec4 FragColor;
 
-uniform vec3 uLightPos;
-uniform vec3 uViewPos;
+layout(std140) uniform FrameUniforms {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec3 uViewPos;
+    float uTime;
+    vec3 uLightPos;
+    float uLightIntensity;
+    vec3 uLightColor;
+};
+
 uniform vec3 uWallColor;
 uniform sampler2D uWallTexture;
 uniform bool uUseTexture;
@@ -8,9 +8,18 @@ out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
+layout(std140) uniform FrameUniforms {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec3 uViewPos;
+    float uTime;
+    vec3 uLightPos;
+    float uLightIntensity;
+    vec3 uLightColor;
+};
+
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
 
 void main()
 {
@@ -18,5 +27,5 @@ void main()
     Normal = mat3(transpose(inverse(uModel))) * aNormal;
     TexCoords = aTexCoord;
     
-    gl_Position = uProjection * uView * vec4(FragPos, 1.0);
+    gl_Position = uViewProjection * vec4(FragPos, 1.0);
 }
@@ -3,18 +3,34 @@
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+in float LifeFraction;
+flat in float SkinLayer;
 
 out vec4 FragColor;
 
+layout(std140) uniform FrameUniforms {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec3 uViewPos;
+    float uTime;
+    vec3 uLightPos;
+    float uLightIntensity;
+    vec3 uLightColor;
+};
+
 uniform sampler2D uTexture;
-uniform vec3 uLightPos;
-uniform vec3 uViewPos;
-uniform float uTime;
+uniform sampler2DArray uTargetSkins;
+uniform bool uInstanced;
 
 void main()
 {
     // Tekstura
-    vec4 texColor = texture(uTexture, TexCoords);
+    vec4 texColor;
+    if (uInstanced)
+        texColor = texture(uTargetSkins, vec3(TexCoords, SkinLayer));
+    else
+        texColor = texture(uTexture, TexCoords);
     
     // Ako je tekstura providna, odbaci fragment
     if (texColor.a < 0.1)
@@ -47,6 +63,9 @@ void main()
     float edgeFactor = 1.0 - abs(dot(norm, viewDir));
     edgeFactor = pow(edgeFactor, 2.0);
     vec3 glow = glowColor * edgeFactor * pulse * 0.15;
+
+    // Meta koja uskoro istice svijetli jace
+    glow *= 1.0 + 3.0 * (1.0 - clamp(LifeFraction, 0.0, 1.0));
     
     // Primijeni attenuation (soft shadows)
     diffuse *= attenuation;
@@ -4,19 +4,52 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;
 
+// Per-target instance data, only read when uInstanced is set
+layout(location = 3) in vec4 aInstancePosRadius;
+layout(location = 4) in vec3 aInstanceData; // depth, remaining life fraction, skin layer
+
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+out float LifeFraction;
+flat out float SkinLayer;
+
+layout(std140) uniform FrameUniforms {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec3 uViewPos;
+    float uTime;
+    vec3 uLightPos;
+    float uLightIntensity;
+    vec3 uLightColor;
+};
 
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
+uniform bool uInstanced;
 
 void main()
 {
-    FragPos = vec3(uModel * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(uModel))) * aNormal;
+    if (uInstanced) {
+        // Billboard basis: the disc always faces the camera
+        vec3 center = aInstancePosRadius.xyz;
+        vec3 scale = vec3(aInstancePosRadius.w, aInstancePosRadius.w, aInstanceData.x);
+        vec3 direction = normalize(uViewPos - center);
+        vec3 right = normalize(cross(vec3(0.0, 1.0, 0.0), direction));
+        vec3 up = cross(direction, right);
+        mat3 basis = mat3(right, up, direction);
+
+        FragPos = center + basis * (aPos * scale);
+        Normal = basis * (aNormal / scale);
+        LifeFraction = aInstanceData.y;
+        SkinLayer = aInstanceData.z;
+    } else {
+        FragPos = vec3(uModel * vec4(aPos, 1.0));
+        Normal = mat3(transpose(inverse(uModel))) * aNormal;
+        LifeFraction = 1.0;
+        SkinLayer = 0.0;
+    }
     TexCoords = aTexCoord;
     
-    gl_Position = uProjection * uView * vec4(FragPos, 1.0);
+    gl_Position = uViewProjection * vec4(FragPos, 1.0);
 }
@@ -1,8 +1,10 @@
 #version 330 core
 layout(location = 0) in vec2 aPos;
 layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in vec4 aColor;
 
 out vec2 TexCoord;
+out vec4 Color;
 
 uniform mat4 uProjection;
 
@@ -10,4 +12,5 @@ void main()
 {
     gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
     TexCoord = aTexCoord;
+    Color = aColor;
 }
@@ -1,12 +0,0 @@
-#version 330 core
-in vec2 TexCoord;
-out vec4 FragColor;
-
-uniform sampler2D uTexture;
-uniform float uAlpha;  // Alpha vrednost (0.0-1.0)
-
-void main()
-{
-    vec4 texColor = texture(uTexture, TexCoord);
-    FragColor = vec4(texColor.rgb, texColor.a * uAlpha);
-}
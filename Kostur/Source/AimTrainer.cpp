@@ -1,52 +1,62 @@
 ﻿#include "../Header/AimTrainer.h"
 #include "../Header/Util.h"
 #include "../Header/OBJLoader.h"
+#include "../Header/RenderState.h"
+#include "../Header/Profiler.h"
+#include "../Header/TextFormat.h"
 #include <cmath>
 #include <cstdlib>
-#include <ctime>
 #include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
 #include <vector>
 
-AimTrainer::AimTrainer(int width, int height)
-    : score(0), lives(3), maxLives(3), gameOver(false), spawnTimer(0.0f),
-    spawnInterval(1.5f), initialSpawnInterval(1.5f), minSpawnInterval(0.3f),
-    targetLifeTimeMultiplier(1.0f), minTargetLifeTime(0.4f),
-    windowWidth(width), windowHeight(height), hitCount(0), totalHitTime(0.0),
-    lastHitTime(0.0), gameOverTime(0.0), survivalTime(0.0), avgHitSpeed(0.0),
-    textRenderer(nullptr), camera(nullptr), exitRequested(false), totalClicks(0),
-    fireMode(FireMode::USP), isMousePressed(false), lastShotTime(0.0), fireRate(0.1),
+AimTrainer::AimTrainer(int width, int height, uint64_t seed, uint64_t startNs)
+    : clock(startNs), simulation(clock, seed),
+    targetInstanceCapacity(0), windowWidth(width), windowHeight(height),
+    textRenderer(nullptr), spriteBatch(nullptr), gpuProfiler(nullptr), exitRequested(false),
     depthTestEnabled(true), faceCullingEnabled(true), gameOverPrintedOnce(false),
-    lastRecoilTime(0.0), recoilAmount(0.0f), recoilRecoverySpeed(8.0f)
+    profilerOverlayVisible(false), profilerRefreshTime(0.0), latencyTracking(true),
+    lastRecoilTime(0.0), recoilAmount(0.0f), recoilRecoverySpeed(8.0f), recoilShotCount(0),
+    lightPosition(0.0f, 4.0f, 0.0f), lightColor(1.0f, 0.95f, 0.8f), lightIntensity(2.0f)
 {
-    srand(static_cast<unsigned int>(time(nullptr)));
-
-    rectShaderProgram = createShader("Shaders/rect.vert", "Shaders/rect.frag");
-    textureShaderProgram = createShader("Shaders/texture.vert", "Shaders/texture.frag");
-    freetypeShaderProgram = createShader("Shaders/freetype.vert", "Shaders/freetype.frag");
-    cylinderShaderProgram = createShader("Shaders/sphere3d.vert", "Shaders/sphere3d.frag");
-    roomShaderProgram = createShader("Shaders/room.vert", "Shaders/room.frag");
-    lightShaderProgram = createShader("Shaders/light.vert", "Shaders/light.frag");
-    weaponShaderProgram = createShader("Shaders/sphere3d.vert", "Shaders/sphere3d.frag");
-
-    camera = new Camera(glm::vec3(0.0f, 0.0f, 3.0f));
-    glm::vec3 spawnZoneCenter(0.0f, 0.0f, -6.5f);
-    camera->lookAt(spawnZoneCenter);
+    spriteShaderProgram = shaderRegistry.acquire("Shaders/sprite.vert", "Shaders/sprite.frag");
+    freetypeShaderProgram = shaderRegistry.acquire("Shaders/freetype.vert", "Shaders/freetype.frag");
+    cylinderShaderProgram = shaderRegistry.acquire("Shaders/sphere3d.vert", "Shaders/sphere3d.frag");
+    roomShaderProgram = shaderRegistry.acquire("Shaders/room.vert", "Shaders/room.frag");
+    lightShaderProgram = shaderRegistry.acquire("Shaders/light.vert", "Shaders/light.frag");
+    weaponShaderProgram = shaderRegistry.acquire("Shaders/sphere3d.vert", "Shaders/sphere3d.frag");
+    cacheUniformLocations();
+    updateProjectionMatrix();
+    initFrameUniforms();
 
     textRenderer = new TextRenderer(freetypeShaderProgram, windowWidth, windowHeight);
-    if (!textRenderer->loadFont("C:/Windows/Fonts/arial.ttf", 48)) {
-        std::cout << "Warning: Failed to load Arial font" << std::endl;
+#ifdef _WIN32
+    const char* fontPath = "C:/Windows/Fonts/arial.ttf";
+#else
+    const char* fontPath = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+#endif
+    if (!textRenderer->loadFont(fontPath, 48)) {
+        std::cout << "Warning: Failed to load font " << fontPath << std::endl;
     }
 
-    studentInfoTexture = loadImageToTexture("Resources/indeks.png");
-    terroristTexture = loadImageToTexture("Resources/terrorist.png");
-    counterTexture = loadImageToTexture("Resources/counter.png");
-    heartTexture = loadImageToTexture("Resources/heart.png");
-    emptyHeartTexture = loadImageToTexture("Resources/empty-heart.png");
-    akTexture = loadImageToTexture("Resources/ak.png");
-    uspTexture = loadImageToTexture("Resources/usp.png");
+    spriteBatch = new SpriteBatch(spriteShaderProgram);
+    gpuProfiler = new GpuProfiler();
+    std::fill(gpuAverages, gpuAverages + static_cast<int>(GpuZone::Count), 0.0);
+    glCounters = GLStats::Counters();
+    for (LatencyTracker::Distribution& stats : latencyStats) {
+        stats = LatencyTracker::Distribution();
+    }
+    std::fill(gpuMaxima, gpuMaxima + static_cast<int>(GpuZone::Count), 0.0);
+    spriteBatch->setProjection(orthoProjection);
+    studentInfoImage = spriteBatch->addImage("Resources/indeks.png");
+    heartImage = spriteBatch->addImage("Resources/heart.png");
+    emptyHeartImage = spriteBatch->addImage("Resources/empty-heart.png");
+    akImage = spriteBatch->addImage("Resources/ak.png");
+    uspImage = spriteBatch->addImage("Resources/usp.png");
+    spriteBatch->buildAtlas();
+
+    targetSkinArray = loadImagesToTextureArray({ "Resources/terrorist.png", "Resources/counter.png" });
     wallTexture = loadImageToTexture("Resources/smooth-white-brick-wall.jpg");
     floorTexture = loadImageToTexture("Resources/floor.jpg");
     ceilingTexture = loadImageToTexture("Resources/ceiling.png");
@@ -57,9 +67,6 @@ AimTrainer::AimTrainer(int width, int height)
     initLight();
     initWallWeapons();
 
-    startTime = glfwGetTime();
-    lastHitTime = startTime;
-
     float boxWidth = 450;
     float boxHeight = 400;
     float boxX = (windowWidth - boxWidth) / 2;
@@ -81,50 +88,36 @@ AimTrainer::AimTrainer(int width, int height)
     std::cout << "  2 - USP-S (Semi-Auto)" << std::endl;
     std::cout << "  D - Toggle Depth Test (debugging)" << std::endl;
     std::cout << "  F - Toggle Face Culling (debugging)" << std::endl;
+    std::cout << "  P - Toggle Profiler Overlay (debugging)" << std::endl;
     std::cout << "  R - Restart (when game over)" << std::endl;
     std::cout << "  ESC - Exit" << std::endl;
 }
 
 AimTrainer::~AimTrainer() {
-    glDeleteVertexArrays(1, &VAO);
+    RenderState::deleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    glDeleteVertexArrays(1, &textVAO);
-    glDeleteBuffers(1, &textVBO);
-    glDeleteVertexArrays(1, &textureVAO);
-    glDeleteBuffers(1, &textureVBO);
-    glDeleteVertexArrays(1, &cylinderVAO);
+    RenderState::deleteVertexArrays(1, &cylinderVAO);
     glDeleteBuffers(1, &cylinderVBO);
     glDeleteBuffers(1, &cylinderEBO);
-    glDeleteVertexArrays(1, &roomVAO);
+    RenderState::deleteVertexArrays(1, &roomVAO);
     glDeleteBuffers(1, &roomVBO);
     glDeleteBuffers(1, &roomEBO);
-    glDeleteVertexArrays(1, &lightVAO);
+    RenderState::deleteVertexArrays(1, &lightVAO);
     glDeleteBuffers(1, &lightVBO);
     glDeleteBuffers(1, &lightEBO);
-    glDeleteProgram(rectShaderProgram);
-    glDeleteProgram(textureShaderProgram);
-    glDeleteProgram(freetypeShaderProgram);
-    glDeleteProgram(cylinderShaderProgram);
-    glDeleteProgram(roomShaderProgram);
-    glDeleteProgram(lightShaderProgram);
-    glDeleteProgram(weaponShaderProgram);
-    glDeleteTextures(1, &studentInfoTexture);
-    glDeleteTextures(1, &terroristTexture);
-    glDeleteTextures(1, &counterTexture);
-    glDeleteTextures(1, &heartTexture);
-    glDeleteTextures(1, &emptyHeartTexture);
-    glDeleteTextures(1, &akTexture);
-    glDeleteTextures(1, &uspTexture);
-    glDeleteTextures(1, &wallTexture);
-    glDeleteTextures(1, &floorTexture);
-    glDeleteTextures(1, &ceilingTexture);
+    glDeleteBuffers(1, &frameUBO);
+    RenderState::deleteTextures(1, &targetSkinArray);
+    RenderState::deleteTextures(1, &wallTexture);
+    RenderState::deleteTextures(1, &floorTexture);
+    RenderState::deleteTextures(1, &ceilingTexture);
 
     for (auto& weapon : wallWeapons) {
         weapon.mesh.cleanup();
     }
 
     if (textRenderer) delete textRenderer;
-    if (camera) delete camera;
+    if (spriteBatch) delete spriteBatch;
+    if (gpuProfiler) delete gpuProfiler;
 }
 
 void AimTrainer::initBuffers() {
@@ -140,7 +133,7 @@ void AimTrainer::initBuffers() {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
+    RenderState::bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
@@ -149,387 +142,321 @@ void AimTrainer::initBuffers() {
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glGenVertexArrays(1, &textVAO);
-    glGenBuffers(1, &textVBO);
-
-    glBindVertexArray(textVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 12, NULL, GL_DYNAMIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glGenVertexArrays(1, &textureVAO);
-    glGenBuffers(1, &textureVBO);
-
-    glBindVertexArray(textureVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textureVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 24, NULL, GL_DYNAMIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindVertexArray(0);
+    RenderState::bindVertexArray(0);
 }
 
-void AimTrainer::spawnTarget() {
-    Target target;
-    target.radius = 1.0f;
-
-    float roomWidth = 20.0f;
-    float roomHeight = 10.0f;
-    float roomDepth = 20.0f;
+void AimTrainer::cacheUniformLocations() {
+    cylinderInstancedLoc = cylinderShaderProgram->getUniformLocation("uInstanced");
+    cylinderSkinsLoc = cylinderShaderProgram->getUniformLocation("uTargetSkins");
 
-    float halfWidth = roomWidth / 2.0f;
-    float halfHeight = roomHeight / 2.0f;
-    float halfDepth = roomDepth / 2.0f;
+    roomModelLoc = roomShaderProgram->getUniformLocation("uModel");
+    roomWallColorLoc = roomShaderProgram->getUniformLocation("uWallColor");
+    roomUseTextureLoc = roomShaderProgram->getUniformLocation("uUseTexture");
+    roomTexLoc = roomShaderProgram->getUniformLocation("uWallTexture");
 
-    float marginX = target.radius * 3.5f;
-    float marginY = target.radius * 3.5f;
-
-    glm::vec3 cameraPos = camera->getPosition();
-    glm::vec3 cameraFront = camera->getFront();
-    glm::vec3 cameraRight = camera->getRight();
-    glm::vec3 cameraUp = camera->getUp();
-
-    int maxAttempts = 20;
-    int attempt = 0;
-    bool foundValidPosition = false;
-
-    glm::vec3 targetPos;
-
-    while (!foundValidPosition && attempt < maxAttempts) {
-        attempt++;
-
-        int wallChoice = rand() % 4;
-
-        switch (wallChoice) {
-        case 0:
-            targetPos.x = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfWidth - marginX);
-            targetPos.y = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfHeight - marginY);
-            targetPos.z = -halfDepth + 0.5f;
-            break;
-
-        case 1:
-            targetPos.x = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfWidth - marginX);
-            targetPos.y = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfHeight - marginY);
-            targetPos.z = halfDepth - 0.5f;
-            break;
-
-        case 2:
-            targetPos.x = -halfWidth + 0.5f;
-            targetPos.y = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfHeight - marginY);
-            targetPos.z = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfDepth - marginX);
-            break;
-
-        case 3:
-            targetPos.x = halfWidth - 0.5f;
-            targetPos.y = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfHeight - marginY);
-            targetPos.z = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * (halfDepth - marginX);
-            break;
-        }
+    lightModelLoc = lightShaderProgram->getUniformLocation("uModel");
 
-        glm::vec3 toTarget = glm::normalize(targetPos - cameraPos);
-        float dotProduct = glm::dot(toTarget, cameraFront);
+    weaponModelLoc = weaponShaderProgram->getUniformLocation("uModel");
+    weaponTexLoc = weaponShaderProgram->getUniformLocation("uTexture");
+    weaponInstancedLoc = weaponShaderProgram->getUniformLocation("uInstanced");
 
-        if (dotProduct > 0.707f) {
-            float rightOffset = glm::dot(toTarget, cameraRight);
-            float upOffset = glm::dot(toTarget, cameraUp);
+    // sphere3d has a sampler2D and a sampler2DArray, they must never share a texture unit
+    cylinderShaderProgram->use();
+    cylinderShaderProgram->setInt(cylinderSkinsLoc, 1);
+    weaponShaderProgram->setInt(weaponTexLoc, 0);
 
-            if (std::abs(rightOffset) < 0.5f && std::abs(upOffset) < 0.4f) {
-                foundValidPosition = true;
-            }
-        }
-    }
+    // The room is static and fully textured, so its uniforms never change after this
+    roomShaderProgram->use();
+    roomShaderProgram->setMat4(roomModelLoc, glm::mat4(1.0f));
+    roomShaderProgram->setInt(roomTexLoc, 0);
+    roomShaderProgram->setVec3(roomWallColorLoc, glm::vec3(0.8f, 0.8f, 0.8f));
+    roomShaderProgram->setInt(roomUseTextureLoc, 1);
+}
 
-    if (!foundValidPosition) {
-        return;
-    }
+void AimTrainer::updateProjectionMatrix() {
+    float projection[16] = {
+        2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
+        0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        -1.0f, 1.0f, 0.0f, 1.0f
+    };
+    std::copy(projection, projection + 16, orthoProjection);
+}
 
-    target.position = targetPos;
-    target.maxLifeTime = (2.0f + static_cast<float>(rand()) / RAND_MAX * 2.0f) * targetLifeTimeMultiplier;
-    target.lifeTime = target.maxLifeTime;
-    target.active = true;
-    target.texture = (rand() % 2 == 0) ? terroristTexture : counterTexture;
+void AimTrainer::initFrameUniforms() {
+    glGenBuffers(1, &frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, frameUBO);
+
+    cylinderShaderProgram->bindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+    roomShaderProgram->bindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+    lightShaderProgram->bindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+    weaponShaderProgram->bindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+
+    frameUniforms.lightPos = lightPosition;
+    frameUniforms.lightColor = lightColor;
+    frameUniforms.lightIntensity = lightIntensity;
+    frameUniforms.padding = 0.0f;
+}
 
-    targets.push_back(target);
+void AimTrainer::updateFrameUniforms() {
+    float aspect = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
+    const Camera& camera = simulation.getCamera();
+    frameUniforms.view = camera.getViewMatrix();
+    frameUniforms.projection = camera.getProjectionMatrix(aspect);
+    frameUniforms.viewProjection = frameUniforms.projection * frameUniforms.view;
+    frameUniforms.viewPos = camera.getPosition();
+    frameUniforms.time = static_cast<float>(glfwGetTime());
+
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frameUniforms);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void AimTrainer::restart() {
-    score = 0;
-    lives = 3;
-    gameOver = false;
-    spawnTimer = 0.0f;
-    spawnInterval = initialSpawnInterval;
-    targetLifeTimeMultiplier = 1.0f;
-    hitCount = 0;
-    totalHitTime = 0.0;
-    gameOverTime = 0.0;
-    survivalTime = 0.0;
-    avgHitSpeed = 0.0;
-    totalClicks = 0;
+    simulation.restart();
     gameOverPrintedOnce = false;
 
-    targets.clear();
-
-    startTime = glfwGetTime();
-    lastHitTime = startTime;
-
     GLFWwindow* window = glfwGetCurrentContext();
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (window) {
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
 
     std::cout << "\n=== NOVA IGRA ===" << std::endl;
 }
 
-void AimTrainer::update(float deltaTime) {
-    if (gameOver) return;
-
-    if (fireMode == FireMode::AK47 && isMousePressed) {
-        double currentTime = glfwGetTime();
-        if (currentTime - lastShotTime >= fireRate) {
-            GLFWwindow* window = glfwGetCurrentContext();
-            double mouseX, mouseY;
-            glfwGetCursorPos(window, &mouseX, &mouseY);
-            handleMouseClick(mouseX, mouseY);
-            lastShotTime = currentTime;
-        }
-    }
-
-    updateDifficulty();
-
-    spawnTimer += deltaTime;
-    if (spawnTimer >= spawnInterval) {
-        spawnTarget();
-        spawnTimer = 0.0f;
+void AimTrainer::applyInput(const InputEvent& event) {
+    switch (event.type) {
+    case InputEvent::Frame:
+        clock.set(event.timeNs);
+        break;
+    case InputEvent::Motion:
+        processMouseMovement(event.x, event.y, event.timeNs);
+        break;
+    case InputEvent::ButtonDown:
+        handleMousePress(event.x, event.y, event.timeNs);
+        break;
+    case InputEvent::ButtonUp:
+        handleMouseRelease(event.timeNs);
+        break;
+    case InputEvent::Key:
+        handleKey(event.key);
+        break;
+    case InputEvent::Tick:
+        update(event.deltaTime);
+        break;
+    default:
+        break;
     }
+}
 
-    for (auto& target : targets) {
-        if (target.active) {
-            target.lifeTime -= deltaTime;
-            if (target.lifeTime <= 0.0f) {
-                target.active = false;
-                lives--;
-
-                if (lives <= 0) {
-                    gameOver = true;
-                    gameOverTime = glfwGetTime();
-                    survivalTime = gameOverTime - startTime;
-                    if (hitCount > 0) {
-                        avgHitSpeed = totalHitTime / hitCount;
-                    }
-
-                    GLFWwindow* window = glfwGetCurrentContext();
-                    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-                }
-            }
+void AimTrainer::update(float deltaTime) {
+    PROFILE_ZONE("AimTrainer::update");
+    bool wasGameOver = simulation.isGameOver();
+    simulation.tick(deltaTime);
+    applyRecoil();
+
+    if (!wasGameOver && simulation.isGameOver()) {
+        GLFWwindow* window = glfwGetCurrentContext();
+        if (window) {
+            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
         }
     }
-
-    targets.erase(
-        std::remove_if(targets.begin(), targets.end(),
-            [](const Target& t) { return !t.active; }),
-        targets.end()
-    );
 }
 
-void AimTrainer::updateDifficulty() {
-    double currentTime = glfwGetTime();
-    double elapsedTime = currentTime - startTime;
+// Kicks the crosshair once for every batch of shots the simulation fired since the last call
+void AimTrainer::applyRecoil() {
+    if (simulation.getShotsFired() == recoilShotCount) return;
+    recoilShotCount = simulation.getShotsFired();
 
-    float difficultyFactor = static_cast<float>(elapsedTime) / 5.0f;
-
-    spawnInterval = initialSpawnInterval - (difficultyFactor * 0.2f);
-    if (spawnInterval < minSpawnInterval) {
-        spawnInterval = minSpawnInterval;
-    }
-
-    targetLifeTimeMultiplier = 1.0f - (difficultyFactor * 0.12f);
-    if (targetLifeTimeMultiplier < minTargetLifeTime) {
-        targetLifeTimeMultiplier = minTargetLifeTime;
-    }
+    lastRecoilTime = glfwGetTime();
+    recoilAmount = (simulation.getFireMode() == FireMode::AK47) ? 1.5f : 1.0f;
 }
 
 void AimTrainer::render() {
+    PROFILE_ZONE("AimTrainer::render");
+    RenderState::beginFrame();
+    gpuProfiler->beginFrame();
+    bool gameOver = simulation.isGameOver();
+    FireMode fireMode = simulation.getFireMode();
+    int score = simulation.getScore();
+    int totalClicks = simulation.getTotalClicks();
+
     if (!gameOver) {
+        updateFrameUniforms();
+
+        // Room, lamp and targets follow the D/F debug toggles. Mounted weapons are open
+        // meshes and are always drawn double-sided with depth test
+        drawQueue.setPassState(RenderPass::Opaque, { depthTestEnabled, faceCullingEnabled, true });
+        drawQueue.setPassState(RenderPass::OpaqueTwoSided, { true, false, true });
+        drawQueue.setPassState(RenderPass::Translucent, { depthTestEnabled, faceCullingEnabled, true });
+
         drawRoom();
         drawLight();
         drawWallWeapons();
+        drawTargets();
 
-        for (const auto& target : targets) {
-            if (target.active) {
-                drawCylinder3D(target.position, target.radius, 0.15f, target.texture);
-            }
-        }
+        drawQueue.submit(gpuProfiler);
     }
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glUseProgram(rectShaderProgram);
-
-    float projection[16] = {
-        2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
-        0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        -1.0f, 1.0f, 0.0f, 1.0f
-    };
-
-    int projLoc = glGetUniformLocation(rectShaderProgram, "uProjection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, projection);
+    RenderState::setEnabled(GL_DEPTH_TEST, false);
+    RenderState::setEnabled(GL_CULL_FACE, false);
+    RenderState::setEnabled(GL_BLEND, true);
+    RenderState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     if (!gameOver) {
         double currentTime = glfwGetTime();
-        double elapsed = currentTime - startTime;
+        double elapsed = simulation.getElapsedTime();
 
-        drawRect(10, 10, 700, 80, 0.0f, 0.0f, 0.0f, 0.7f);
-        drawRect(12, 12, 696, 76, 0.2f, 0.2f, 0.2f, 0.8f);
+        spriteBatch->drawRect(10, 10, 700, 80, 0.0f, 0.0f, 0.0f, 0.7f);
+        spriteBatch->drawRect(12, 12, 696, 76, 0.2f, 0.2f, 0.2f, 0.8f);
 
-        for (int i = 0; i < maxLives; i++) {
-            if (i < lives) {
-                drawTexture(20 + i * 35, 22, 28, 28, heartTexture);
+        for (int i = 0; i < simulation.getMaxLives(); i++) {
+            if (i < simulation.getLives()) {
+                spriteBatch->drawImage(heartImage, 20 + i * 35, 22, 28, 28);
             }
             else {
-                drawTexture(20 + i * 35, 22, 28, 28, emptyHeartTexture);
+                spriteBatch->drawImage(emptyHeartImage, 20 + i * 35, 22, 28, 28);
             }
         }
 
-        int minutes = static_cast<int>(elapsed) / 60;
-        int seconds = static_cast<int>(elapsed) % 60;
-        int centiseconds = static_cast<int>((elapsed - static_cast<int>(elapsed)) * 100) % 100;
-
-        std::stringstream timeStr;
-        timeStr << std::setfill('0') << std::setw(2) << minutes << ":"
-            << std::setw(2) << seconds << ":"
-            << std::setw(2) << centiseconds;
-
-        textRenderer->renderText(timeStr.str(), 130, 35, 0.6f, 0.2f, 1.0f, 1.0f);
-
-        std::stringstream statsStr;
-        statsStr << "Hits: " << score << "/" << totalClicks;
-        textRenderer->renderText(statsStr.str(), 330, 35, 0.5f, 0.4f, 1.0f, 0.4f);
-
-        double avgSpeed = 0.0;
-        if (hitCount > 0) {
-            avgSpeed = totalHitTime / hitCount;
-        }
-
-        std::stringstream speedStr;
-        speedStr << "Speed: " << std::fixed << std::setprecision(2) << avgSpeed << " s";
-        textRenderer->renderText(speedStr.str(), 480, 35, 0.45f, 1.0f, 0.8f, 0.3f);
-
-        std::string modeStr = (fireMode == FireMode::USP) ? "USP" : "AK-47";
-        float modeR = (fireMode == FireMode::USP) ? 0.7f : 1.0f;
-        float modeG = (fireMode == FireMode::USP) ? 0.7f : 0.5f;
-        float modeB = (fireMode == FireMode::USP) ? 0.7f : 0.2f;
-        textRenderer->renderText(modeStr, 630, 35, 0.4f, modeR, modeG, modeB);
-
         float infoWidth = 400.0f;
         float infoHeight = 200.0f;
         float infoX = 20;
         float infoY = windowHeight - infoHeight - 20;
 
         float padding = 10.0f;
-        drawRect(infoX - padding, infoY - padding, infoWidth + 2 * padding, infoHeight + 2 * padding, 0.1f, 0.1f, 0.1f, 0.5f);
+        spriteBatch->drawRect(infoX - padding, infoY - padding, infoWidth + 2 * padding, infoHeight + 2 * padding, 0.1f, 0.1f, 0.1f, 0.5f);
 
-        drawTexture(infoX, infoY, infoWidth, infoHeight, studentInfoTexture, 1.0f);
+        spriteBatch->drawImage(studentInfoImage, infoX, infoY, infoWidth, infoHeight, 1.0f);
 
         float weaponWidth = 300.0f;
         float weaponHeight = 150.0f;
         float weaponX = windowWidth - weaponWidth - 20;
         float weaponY = windowHeight - weaponHeight - 20;
 
-        unsigned int weaponTexture = (fireMode == FireMode::USP) ? uspTexture : akTexture;
-        drawTexture(weaponX, weaponY, weaponWidth, weaponHeight, weaponTexture);
-    }
-    else {
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        int weaponImage = (fireMode == FireMode::USP) ? uspImage : akImage;
+        spriteBatch->drawImage(weaponImage, weaponX, weaponY, weaponWidth, weaponHeight);
 
-        glClear(GL_DEPTH_BUFFER_BIT);
+        float centerX = windowWidth / 2.0f;
+        float centerY = windowHeight / 2.0f;
 
-        glUseProgram(rectShaderProgram);
+        double timeSinceRecoil = currentTime - lastRecoilTime;
+        if (recoilAmount > 0.0f) {
+            recoilAmount -= recoilRecoverySpeed * static_cast<float>(timeSinceRecoil);
+            if (recoilAmount < 0.0f) recoilAmount = 0.0f;
+            lastRecoilTime = currentTime;
+        }
 
-        float projection[16] = {
-            2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
-            0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
-            0.0f, 0.0f, 1.0f, 0.0f,
-            -1.0f, 1.0f, 0.0f, 1.0f
-        };
+        float recoilExpansion = 1.0f + recoilAmount;
 
-        int projLoc = glGetUniformLocation(rectShaderProgram, "uProjection");
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, projection);
+        float crosshairSize = 18.0f * recoilExpansion;
+        float crosshairThickness = 4.0f;
+        float crosshairGap = 6.0f * recoilExpansion;
 
-        drawRect(0, 0, static_cast<float>(windowWidth), static_cast<float>(windowHeight), 0.0f, 0.0f, 0.0f, 0.7f);
+        float greenIntensity = 0.8f + recoilAmount * 0.2f;
+        if (greenIntensity > 1.0f) greenIntensity = 1.0f;
+
+        spriteBatch->drawRect(centerX - crosshairSize - crosshairGap, centerY - crosshairThickness / 2,
+            crosshairSize, crosshairThickness, 0.0f, greenIntensity, 0.0f, 0.95f);
+        spriteBatch->drawRect(centerX + crosshairGap, centerY - crosshairThickness / 2,
+            crosshairSize, crosshairThickness, 0.0f, greenIntensity, 0.0f, 0.95f);
+        spriteBatch->drawRect(centerX - crosshairThickness / 2, centerY - crosshairSize - crosshairGap,
+            crosshairThickness, crosshairSize, 0.0f, greenIntensity, 0.0f, 0.95f);
+        spriteBatch->drawRect(centerX - crosshairThickness / 2, centerY + crosshairGap,
+            crosshairThickness, crosshairSize, 0.0f, greenIntensity, 0.0f, 0.95f);
+
+        // The whole HUD (panels, icons, crosshair) goes out in one draw, text is drawn on top
+        gpuProfiler->begin(GpuZone::HudSprites);
+        spriteBatch->flush();
+
+        int minutes = static_cast<int>(elapsed) / 60;
+        int seconds = static_cast<int>(elapsed) % 60;
+        int centiseconds = static_cast<int>((elapsed - static_cast<int>(elapsed)) * 100) % 100;
+
+        TextBuffer<16> timeStr;
+        timeStr.appendInt(minutes, 2).append(":").appendInt(seconds, 2).append(":").appendInt(centiseconds, 2);
+        textRenderer->drawText(timeStr.text(), timeStr.size(), 130, 35, 0.6f, 0.2f, 1.0f, 1.0f);
+
+        TextBuffer<32> statsStr;
+        statsStr.append("Hits: ").appendInt(score).append("/").appendInt(totalClicks);
+        textRenderer->drawText(statsStr.text(), statsStr.size(), 330, 35, 0.5f, 0.4f, 1.0f, 0.4f);
+
+        double avgSpeed = 0.0;
+        if (simulation.getHitCount() > 0) {
+            avgSpeed = simulation.getTotalHitTime() / simulation.getHitCount();
+        }
+
+        TextBuffer<32> speedStr;
+        speedStr.append("Speed: ").appendFixed(avgSpeed, 2).append(" s");
+        textRenderer->drawText(speedStr.text(), speedStr.size(), 480, 35, 0.45f, 1.0f, 0.8f, 0.3f);
+
+        const char* modeStr = (fireMode == FireMode::USP) ? "USP" : "AK-47";
+        float modeR = (fireMode == FireMode::USP) ? 0.7f : 1.0f;
+        float modeG = (fireMode == FireMode::USP) ? 0.7f : 0.5f;
+        float modeB = (fireMode == FireMode::USP) ? 0.7f : 0.2f;
+        textRenderer->drawText(modeStr, static_cast<int>(std::strlen(modeStr)), 630, 35, 0.4f, modeR, modeG, modeB);
+        gpuProfiler->begin(GpuZone::Text);
+        textRenderer->flush();
+        gpuProfiler->end();
+    }
+    else {
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        spriteBatch->drawRect(0, 0, static_cast<float>(windowWidth), static_cast<float>(windowHeight), 0.0f, 0.0f, 0.0f, 0.7f);
 
         float boxWidth = 450;
         float boxHeight = 400;
         float boxX = (windowWidth - boxWidth) / 2;
         float boxY = (windowHeight - boxHeight) / 2;
 
-        drawRect(boxX, boxY, boxWidth, boxHeight, 0.0f, 0.0f, 0.0f, 1.0f);
-        drawRect(boxX + 2, boxY + 2, boxWidth - 4, boxHeight - 4, 0.3f, 0.3f, 0.3f, 1.0f);
-
-        drawRect(restartButton.x, restartButton.y, restartButton.width, restartButton.height, 0.2f, 0.8f, 0.2f, 1.0f);
-        drawRect(exitButton.x, exitButton.y, exitButton.width, exitButton.height, 0.8f, 0.2f, 0.2f, 1.0f);
+        spriteBatch->drawRect(boxX, boxY, boxWidth, boxHeight, 0.0f, 0.0f, 0.0f, 1.0f);
+        spriteBatch->drawRect(boxX + 2, boxY + 2, boxWidth - 4, boxHeight - 4, 0.3f, 0.3f, 0.3f, 1.0f);
 
-        std::string gameOverText = "GAME OVER";
-        float gameOverWidth = textRenderer->getTextWidth(gameOverText, 1.0f);
-        float gameOverX = boxX + (boxWidth - gameOverWidth) / 2;
-        textRenderer->renderText(gameOverText, gameOverX, boxY + 50, 1.0f, 1.0f, 0.2f, 0.2f);
+        spriteBatch->drawRect(restartButton.x, restartButton.y, restartButton.width, restartButton.height, 0.2f, 0.8f, 0.2f, 1.0f);
+        spriteBatch->drawRect(exitButton.x, exitButton.y, exitButton.width, exitButton.height, 0.8f, 0.2f, 0.2f, 1.0f);
+        gpuProfiler->begin(GpuZone::HudSprites);
+        spriteBatch->flush();
 
-        int survivalMinutes = static_cast<int>(survivalTime) / 60;
-        int survivalSeconds = static_cast<int>(survivalTime) % 60;
-        std::stringstream timeText;
-        timeText << "Time: " << survivalMinutes << ":" << std::setfill('0') << std::setw(2) << survivalSeconds;
+        float centerX = boxX + boxWidth / 2;
+        textRenderer->drawText("GAME OVER", 9, centerX, boxY + 50, 1.0f, 1.0f, 0.2f, 0.2f, 1.0f, TextAlign::Center);
 
-        float timeWidth = textRenderer->getTextWidth(timeText.str(), 0.5f);
-        float timeX = boxX + (boxWidth - timeWidth) / 2;
-        textRenderer->renderText(timeText.str(), timeX, boxY + 110, 0.5f, 0.8f, 0.8f, 1.0f);
+        int survivalMinutes = static_cast<int>(simulation.getSurvivalTime()) / 60;
+        int survivalSeconds = static_cast<int>(simulation.getSurvivalTime()) % 60;
+        TextBuffer<32> timeText;
+        timeText.append("Time: ").appendInt(survivalMinutes).append(":").appendInt(survivalSeconds, 2);
+        textRenderer->drawText(timeText.text(), timeText.size(), centerX, boxY + 110, 0.5f, 0.8f, 0.8f, 1.0f, 1.0f, TextAlign::Center);
 
         float accuracy = 0.0f;
         if (totalClicks > 0) {
             accuracy = (static_cast<float>(score) / static_cast<float>(totalClicks)) * 100.0f;
         }
 
-        std::stringstream accuracyText;
-        accuracyText << "Accuracy: " << std::fixed << std::setprecision(1) << accuracy << "%";
-        float accuracyWidth = textRenderer->getTextWidth(accuracyText.str(), 0.5f);
-        float accuracyX = boxX + (boxWidth - accuracyWidth) / 2;
-        textRenderer->renderText(accuracyText.str(), accuracyX, boxY + 150, 0.5f, 0.4f, 1.0f, 0.4f);
-
-        std::stringstream hitsText;
-        hitsText << "Hits: " << score << " / " << totalClicks;
-        float hitsWidth = textRenderer->getTextWidth(hitsText.str(), 0.45f);
-        float hitsX = boxX + (boxWidth - hitsWidth) / 2;
-        textRenderer->renderText(hitsText.str(), hitsX, boxY + 185, 0.45f, 0.9f, 0.9f, 0.9f);
-
-        double avgSpeed = avgHitSpeed;
+        TextBuffer<32> accuracyText;
+        accuracyText.append("Accuracy: ").appendFixed(accuracy, 1).append("%");
+        textRenderer->drawText(accuracyText.text(), accuracyText.size(), centerX, boxY + 150, 0.5f, 0.4f, 1.0f, 0.4f, 1.0f, TextAlign::Center);
 
-        std::stringstream speedText;
-        speedText << "Speed: " << std::fixed << std::setprecision(2) << avgSpeed << " s";
-        float speedWidth = textRenderer->getTextWidth(speedText.str(), 0.45f);
-        float speedX = boxX + (boxWidth - speedWidth) / 2;
-        textRenderer->renderText(speedText.str(), speedX, boxY + 220, 0.45f, 1.0f, 0.8f, 0.3f);
+        TextBuffer<32> hitsText;
+        hitsText.append("Hits: ").appendInt(score).append(" / ").appendInt(totalClicks);
+        textRenderer->drawText(hitsText.text(), hitsText.size(), centerX, boxY + 185, 0.45f, 0.9f, 0.9f, 0.9f, 1.0f, TextAlign::Center);
 
-        float restartTextWidth = textRenderer->getTextWidth("RESTART", 0.5f);
-        float restartTextX = restartButton.x + (restartButton.width - restartTextWidth) / 2;
-        textRenderer->renderText("RESTART", restartTextX, restartButton.y + 30, 0.5f, 1.0f, 1.0f, 1.0f);
+        TextBuffer<32> speedText;
+        speedText.append("Speed: ").appendFixed(simulation.getAverageHitSpeed(), 2).append(" s");
+        textRenderer->drawText(speedText.text(), speedText.size(), centerX, boxY + 220, 0.45f, 1.0f, 0.8f, 0.3f, 1.0f, TextAlign::Center);
 
-        float exitTextWidth = textRenderer->getTextWidth("EXIT", 0.5f);
-        float exitTextX = exitButton.x + (exitButton.width - exitTextWidth) / 2;
-        textRenderer->renderText("EXIT", exitTextX, exitButton.y + 30, 0.5f, 1.0f, 1.0f, 1.0f);
+        textRenderer->drawText("RESTART", 7, restartButton.x + restartButton.width / 2, restartButton.y + 30, 0.5f, 1.0f, 1.0f, 1.0f, 1.0f, TextAlign::Center);
+        textRenderer->drawText("EXIT", 4, exitButton.x + exitButton.width / 2, exitButton.y + 30, 0.5f, 1.0f, 1.0f, 1.0f, 1.0f, TextAlign::Center);
+        gpuProfiler->begin(GpuZone::Text);
+        textRenderer->flush();
+        gpuProfiler->end();
 
         if (!gameOverPrintedOnce) {
             std::cout << "\n\n=== GAME OVER ===" << std::endl;
-            std::cout << "Vreme prezivljanja: " << (int)survivalTime << "s" << std::endl;
+            std::cout << "Vreme prezivljanja: " << (int)simulation.getSurvivalTime() << "s" << std::endl;
             std::cout << "Ukupno pogodaka: " << score << std::endl;
-            std::cout << "Prosecna brzina pogadjanja: " << avgHitSpeed << "s" << std::endl;
+            std::cout << "Prosecna brzina pogadjanja: " << simulation.getAverageHitSpeed() << "s" << std::endl;
             std::cout << "\nPritisni 'R' za restart ili klikni na zeleno dugme" << std::endl;
             std::cout << "Pritisni 'ESC' za izlaz ili klikni na crveno dugme" << std::endl;
             std::cout << "================\n" << std::endl;
@@ -537,138 +464,114 @@ void AimTrainer::render() {
         }
     }
 
-    if (depthTestEnabled) {
-        glEnable(GL_DEPTH_TEST);
-    }
-
-    if (!gameOver) {
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        glUseProgram(rectShaderProgram);
-
-        float projection[16] = {
-            2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
-            0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
-            0.0f, 0.0f, 1.0f, 0.0f,
-            -1.0f, 1.0f, 0.0f, 1.0f
-        };
-
-        int projLoc = glGetUniformLocation(rectShaderProgram, "uProjection");
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, projection);
-
-        float centerX = windowWidth / 2.0f;
-        float centerY = windowHeight / 2.0f;
-
-        double currentTime = glfwGetTime();
-        double timeSinceRecoil = currentTime - lastRecoilTime;
-        if (recoilAmount > 0.0f) {
-            recoilAmount -= recoilRecoverySpeed * static_cast<float>(timeSinceRecoil);
-            if (recoilAmount < 0.0f) recoilAmount = 0.0f;
-            lastRecoilTime = currentTime;
-        }
-
-        float recoilExpansion = 1.0f + recoilAmount;
-
-        float crosshairSize = 18.0f * recoilExpansion;
-        float crosshairThickness = 4.0f;
-        float crosshairGap = 6.0f * recoilExpansion;
-
-        float greenIntensity = 0.8f + recoilAmount * 0.2f;
-        if (greenIntensity > 1.0f) greenIntensity = 1.0f;
-
-        drawRect(centerX - crosshairSize - crosshairGap, centerY - crosshairThickness / 2,
-            crosshairSize, crosshairThickness, 0.0f, greenIntensity, 0.0f, 0.95f);
-        drawRect(centerX + crosshairGap, centerY - crosshairThickness / 2,
-            crosshairSize, crosshairThickness, 0.0f, greenIntensity, 0.0f, 0.95f);
-        drawRect(centerX - crosshairThickness / 2, centerY - crosshairSize - crosshairGap,
-            crosshairThickness, crosshairSize, 0.0f, greenIntensity, 0.0f, 0.95f);
-        drawRect(centerX - crosshairThickness / 2, centerY + crosshairGap,
-            crosshairThickness, crosshairSize, 0.0f, greenIntensity, 0.0f, 0.95f);
+    gpuProfiler->endFrame();
 
-        if (depthTestEnabled) glEnable(GL_DEPTH_TEST);
-        if (faceCullingEnabled) glEnable(GL_CULL_FACE);
+    // Drawn after the GPU passes close, so the overlay does not time itself
+    if (profilerOverlayVisible) {
+        drawProfilerOverlay();
     }
 }
 
-void AimTrainer::drawRect(float x, float y, float width, float height, float r, float g, float b, float alpha) {
-    glUseProgram(rectShaderProgram);
-
-    float projection[16] = {
-        2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
-        0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        -1.0f, 1.0f, 0.0f, 1.0f
-    };
-
-    int projLoc = glGetUniformLocation(rectShaderProgram, "uProjection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, projection);
-
-    glBindVertexArray(textVAO);
-
-    float vertices[] = {
-        x, y,
-        x + width, y,
-        x + width, y + height,
-        x, y,
-        x + width, y + height,
-        x, y + height
-    };
-
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-
-    int colorLoc = glGetUniformLocation(rectShaderProgram, "uColor");
-    glUniform3f(colorLoc, r, g, b);
-
-    int alphaLoc = glGetUniformLocation(rectShaderProgram, "uAlpha");
-    glUniform1f(alphaLoc, alpha);
-
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void AimTrainer::toggleProfilerOverlay() {
+    profilerOverlayVisible = !profilerOverlayVisible;
+    profilerRefreshTime = 0.0;
+    std::cout << "\n[PROFILER] " << (profilerOverlayVisible ? "✓ ON" : "✗ OFF") << std::endl;
 }
 
-void AimTrainer::drawTexture(float x, float y, float width, float height, unsigned int texture, float alpha) {
-    glUseProgram(textureShaderProgram);
+// Per-zone CPU time over the last Profiler::HISTORY_FRAMES frames. The numbers refresh
+// four times a second so they stay readable and the text cache keeps hitting between refreshes
+void AimTrainer::drawProfilerOverlay() {
+    double now = glfwGetTime();
+    if (now >= profilerRefreshTime) {
+        Profiler::collect(profilerStats);
+        for (int zone = 0; zone < static_cast<int>(GpuZone::Count); zone++) {
+            gpuAverages[zone] = gpuProfiler->averageMs(static_cast<GpuZone>(zone));
+            gpuMaxima[zone] = gpuProfiler->maxMs(static_cast<GpuZone>(zone));
+        }
+        glCounters = GLStats::lastFrame();
+        for (int stage = 0; stage < LatencyTracker::StageCount; stage++) {
+            latencyStats[stage] = latencyTracker.distribution(static_cast<LatencyTracker::Stage>(stage));
+        }
+        profilerRefreshTime = now + 0.25;
+    }
 
-    float projection[16] = {
-        2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
-        0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        -1.0f, 1.0f, 0.0f, 1.0f
-    };
+    const float panelX = windowWidth - 480.0f;
+    const float panelY = 100.0f;
+    const float rowHeight = 22.0f;
+    const int gpuRows = static_cast<int>(GpuZone::Count);
+    const float panelHeight = 50.0f + rowHeight * (profilerStats.size() + gpuRows + 2);
 
-    int projLoc = glGetUniformLocation(textureShaderProgram, "uProjection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, projection);
+    spriteBatch->drawRect(panelX, panelY, 470, panelHeight, 0.0f, 0.0f, 0.0f, 0.75f);
+    spriteBatch->flush();
 
-    int alphaLoc = glGetUniformLocation(textureShaderProgram, "uAlpha");
-    glUniform1f(alphaLoc, alpha);
+    float textY = panelY + 28;
+    textRenderer->drawText("zona", 4, panelX + 10, textY, 0.35f, 0.7f, 0.7f, 0.7f);
+    textRenderer->drawText("min / avg / p99 ms", 18, panelX + 280, textY, 0.35f, 0.7f, 0.7f, 0.7f);
 
-    float vertices[] = {
-        x, y, 0.0f, 1.0f,
-        x + width, y, 1.0f, 1.0f,
-        x + width, y + height, 1.0f, 0.0f,
-        x, y, 0.0f, 1.0f,
-        x + width, y + height, 1.0f, 0.0f,
-        x, y + height, 0.0f, 0.0f
-    };
+    for (const Profiler::ZoneStats& zone : profilerStats) {
+        textY += rowHeight;
+        textRenderer->drawText(zone.name, static_cast<int>(std::strlen(zone.name)), panelX + 10, textY, 0.35f, 1.0f, 1.0f, 1.0f);
 
-    glBindVertexArray(textureVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textureVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        TextBuffer<48> numbers;
+        numbers.appendFixed(zone.minMs, 3).append(" / ").appendFixed(zone.avgMs, 3).append(" / ").appendFixed(zone.p99Ms, 3);
+        float red = zone.p99Ms > 2.0 ? 1.0f : 0.6f;
+        textRenderer->drawText(numbers.text(), numbers.size(), panelX + 280, textY, 0.35f, red, 1.0f, 0.6f);
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    // GPU passes, read back GpuProfiler::FRAMES_IN_FLIGHT frames late
+    textY += rowHeight * 2;
+    textRenderer->drawText("GPU pass", 8, panelX + 10, textY, 0.35f, 0.7f, 0.7f, 0.7f);
+    textRenderer->drawText("avg / max ms", 12, panelX + 280, textY, 0.35f, 0.7f, 0.7f, 0.7f);
+    for (int zone = 0; zone < gpuRows; zone++) {
+        textY += rowHeight;
+        const char* name = GpuProfiler::zoneName(static_cast<GpuZone>(zone));
+        textRenderer->drawText(name, static_cast<int>(std::strlen(name)), panelX + 10, textY, 0.35f, 0.6f, 0.9f, 1.0f);
+
+        TextBuffer<32> numbers;
+        numbers.appendFixed(gpuAverages[zone], 3).append(" / ").appendFixed(gpuMaxima[zone], 3);
+        textRenderer->drawText(numbers.text(), numbers.size(), panelX + 280, textY, 0.35f, 0.6f, 0.9f, 1.0f);
+    }
 
-    int texLoc = glGetUniformLocation(textureShaderProgram, "uTexture");
-    glUniform1i(texLoc, 0);
+    // GL calls of the previous frame, overlay included. Left of the timing panel
+    const float glPanelX = panelX - 260.0f;
+    spriteBatch->drawRect(glPanelX, panelY, 250, 50.0f + rowHeight * GLStats::CounterCount, 0.0f, 0.0f, 0.0f, 0.75f);
+    spriteBatch->flush();
+
+    textY = panelY + 28;
+    textRenderer->drawText("GL / frame", 10, glPanelX + 10, textY, 0.35f, 0.7f, 0.7f, 0.7f);
+    for (int i = 0; i < GLStats::CounterCount; i++) {
+        textY += rowHeight;
+        const char* name = GLStats::counterName(static_cast<GLStats::Counter>(i));
+        textRenderer->drawText(name, static_cast<int>(std::strlen(name)), glPanelX + 10, textY, 0.35f, 1.0f, 0.85f, 0.5f);
+
+        TextBuffer<24> value;
+        value.appendInt(static_cast<long long>(glCounters.values[i]));
+        textRenderer->drawText(value.text(), value.size(), glPanelX + 170, textY, 0.35f, 1.0f, 0.85f, 0.5f);
+    }
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    // Click latency, below the GL panel
+    const float latencyPanelY = panelY + 60.0f + rowHeight * GLStats::CounterCount;
+    spriteBatch->drawRect(glPanelX, latencyPanelY, 250, 50.0f + rowHeight * LatencyTracker::StageCount, 0.0f, 0.0f, 0.0f, 0.75f);
+    spriteBatch->flush();
+
+    textY = latencyPanelY + 28;
+    textRenderer->drawText("klik do", 7, glPanelX + 10, textY, 0.35f, 0.7f, 0.7f, 0.7f);
+    textRenderer->drawText("p50 / p99 ms", 12, glPanelX + 110, textY, 0.35f, 0.7f, 0.7f, 0.7f);
+    for (int stage = 0; stage < LatencyTracker::StageCount; stage++) {
+        textY += rowHeight;
+        const char* name = LatencyTracker::stageName(static_cast<LatencyTracker::Stage>(stage));
+        textRenderer->drawText(name, static_cast<int>(std::strlen(name)), glPanelX + 10, textY, 0.35f, 0.7f, 1.0f, 0.7f);
+
+        TextBuffer<32> numbers;
+        numbers.appendFixed(latencyStats[stage].p50Ms, 2).append(" / ").appendFixed(latencyStats[stage].p99Ms, 2);
+        textRenderer->drawText(numbers.text(), numbers.size(), glPanelX + 110, textY, 0.35f, 0.7f, 1.0f, 0.7f);
+    }
+    textRenderer->flush();
 }
 
-void AimTrainer::handleMouseClick(double mouseX, double mouseY) {
-    if (gameOver) {
+void AimTrainer::handleMouseClick(double mouseX, double mouseY, uint64_t inputTimeNs) {
+    PROFILE_ZONE("AimTrainer::handleMouseClick");
+    if (simulation.isGameOver()) {
         if (isPointInRect(static_cast<float>(mouseX), static_cast<float>(mouseY),
             restartButton.x, restartButton.y, restartButton.width, restartButton.height)) {
             restart();
@@ -680,83 +583,51 @@ void AimTrainer::handleMouseClick(double mouseX, double mouseY) {
         return;
     }
 
-    lastRecoilTime = glfwGetTime();
-    recoilAmount = (fireMode == FireMode::AK47) ? 1.5f : 1.0f;
-
-    double currentTime = glfwGetTime();
-    glm::vec3 rayOrigin = camera->getPosition();
-    glm::vec3 rayDir = camera->getFront();
+    Simulation::ShotResult result = simulation.click(inputTimeNs);
+    applyRecoil();
 
-    // PRVO: Provjeri da li je pogođeno oružje na zidu (MNOGO MANJI hitbox)
-    bool weaponPickedUp = false;
-    for (const auto& weapon : wallWeapons) {
-        // SMANJENI hitbox na samo 1.5% originalne veličine (bilo je 5%)
-        glm::vec3 weaponMin = weapon.position - weapon.scale * 0.004f;
-        glm::vec3 weaponMax = weapon.position + weapon.scale * 0.004f;
-
-        if (rayAABBIntersection(rayOrigin, rayDir, weaponMin, weaponMax)) {
-            if (weapon.isAK && fireMode != FireMode::AK47) {
-                setFireMode(FireMode::AK47);
-                std::cout << "✓ Picked up AK-47 from the wall!" << std::endl;
-                weaponPickedUp = true;
-                break;
-            }
-            else if (!weapon.isAK && fireMode != FireMode::USP) {
-                setFireMode(FireMode::USP);
-                std::cout << "✓ Picked up USP-S from the wall!" << std::endl;
-                weaponPickedUp = true;
-                break;
-            }
-            weaponPickedUp = true;
-            break;
-        }
-    }
-
-    if (weaponPickedUp) {
-        return;
-    }
-
-    // DRUGO: Brojanje klika (samo ako nije oružje)
-    totalClicks++;
-
-    // TREĆE: Provjeri da li je pogođen target
-    bool hit = false;
-    for (auto& target : targets) {
-        if (target.active) {
-            if (raySphereIntersection(rayOrigin, rayDir, target.position, target.radius)) {
-                target.active = false;
-                score++;
-                hit = true;
-
-                double timeSinceLastHit = currentTime - lastHitTime;
-                totalHitTime += timeSinceLastHit;
-                hitCount++;
-                lastHitTime = currentTime;
-
-                std::cout << "\nHIT! Pogodaka: " << score << std::endl;
-                break;
-            }
-        }
+    if (latencyTracking && inputTimeNs != 0 && result != Simulation::ShotResult::Pickup) {
+        latencyTracker.clickResolved(inputTimeNs);
     }
 }
 
-void AimTrainer::handleMousePress(double mouseX, double mouseY) {
-    isMousePressed = true;
-    lastShotTime = glfwGetTime();
-    handleMouseClick(mouseX, mouseY);
+void AimTrainer::handleMousePress(double mouseX, double mouseY, uint64_t inputTimeNs) {
+    simulation.pressTrigger(inputTimeNs);
+    handleMouseClick(mouseX, mouseY, inputTimeNs);
 }
 
-void AimTrainer::handleMouseRelease() {
-    isMousePressed = false;
+void AimTrainer::handleMouseRelease(uint64_t inputTimeNs) {
+    simulation.releaseTrigger(inputTimeNs);
 }
 
 void AimTrainer::setFireMode(FireMode mode) {
-    fireMode = mode;
-    if (mode == FireMode::USP) {
-        std::cout << "\n[WEAPON] USP-S (Semi-Auto)" << std::endl;
-    }
-    else {
-        std::cout << "\n[WEAPON] AK-47 (Full-Auto)" << std::endl;
+    simulation.setFireMode(mode);
+}
+
+void AimTrainer::handleKey(int key) {
+    switch (key) {
+    case GLFW_KEY_R:
+        if (simulation.isGameOver()) {
+            restart();
+        }
+        break;
+    case GLFW_KEY_1:
+        setFireMode(FireMode::AK47);
+        break;
+    case GLFW_KEY_2:
+        setFireMode(FireMode::USP);
+        break;
+    case GLFW_KEY_D:
+        toggleDepthTest();
+        break;
+    case GLFW_KEY_F:
+        toggleFaceCulling();
+        break;
+    case GLFW_KEY_P:
+        toggleProfilerOverlay();
+        break;
+    default:
+        break;
     }
 }
 
@@ -851,7 +722,7 @@ void AimTrainer::initCylinder() {
     glGenBuffers(1, &cylinderVBO);
     glGenBuffers(1, &cylinderEBO);
 
-    glBindVertexArray(cylinderVAO);
+    RenderState::bindVertexArray(cylinderVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, cylinderVBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
@@ -868,61 +739,59 @@ void AimTrainer::initCylinder() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    glBindVertexArray(0);
-}
-
-void AimTrainer::drawCylinder3D(const glm::vec3& position, float radius, float depth, unsigned int texture) {
-    glUseProgram(cylinderShaderProgram);
-
-    glm::vec3 cameraPos = camera->getPosition();
-    glm::vec3 direction = glm::normalize(cameraPos - position);
-
-    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
-    glm::vec3 right = glm::normalize(glm::cross(up, direction));
-    glm::vec3 newUp = glm::cross(direction, right);
-
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
-
-    glm::mat4 rotation = glm::mat4(1.0f);
-    rotation[0] = glm::vec4(right, 0.0f);
-    rotation[1] = glm::vec4(newUp, 0.0f);
-    rotation[2] = glm::vec4(direction, 0.0f);
-
-    model = model * rotation;
-    model = glm::scale(model, glm::vec3(radius, radius, depth));
-
-    glm::mat4 view = camera->getViewMatrix();
-    float aspect = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
-    glm::mat4 projection = camera->getProjectionMatrix(aspect);
-
-    int modelLoc = glGetUniformLocation(cylinderShaderProgram, "uModel");
-    int viewLoc = glGetUniformLocation(cylinderShaderProgram, "uView");
-    int projLoc = glGetUniformLocation(cylinderShaderProgram, "uProjection");
+    // Instance stream, refilled every frame in drawTargets
+    glGenBuffers(1, &targetInstanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, targetInstanceVBO);
 
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(TargetInstance), (void*)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
 
-    glm::vec3 lightPos(0.0f, 4.0f, 0.0f);
-    int lightPosLoc = glGetUniformLocation(cylinderShaderProgram, "uLightPos");
-    glUniform3fv(lightPosLoc, 1, glm::value_ptr(lightPos));
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(TargetInstance), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
 
-    int viewPosLoc = glGetUniformLocation(cylinderShaderProgram, "uViewPos");
-    glUniform3fv(viewPosLoc, 1, glm::value_ptr(camera->getPosition()));
+    RenderState::bindVertexArray(0);
+}
 
-    float currentTime = static_cast<float>(glfwGetTime());
-    int timeLoc = glGetUniformLocation(cylinderShaderProgram, "uTime");
-    glUniform1f(timeLoc, currentTime);
+void AimTrainer::drawTargets() {
+    PROFILE_ZONE("AimTrainer::drawTargets");
+    targetInstances.clear();
+    const TargetPool& targets = simulation.getTargets();
+    for (int i = 0; i < targets.size(); i++) {
+        TargetInstance instance;
+        instance.position = targets.getPosition(i);
+        instance.radius = targets.getRadius(i);
+        instance.depth = 0.15f;
+        float maxLifeTime = targets.getMaxLifeTime(i);
+        instance.lifeFraction = maxLifeTime > 0.0f ? targets.getLifeTime(i) / maxLifeTime : 1.0f;
+        instance.skin = static_cast<float>(targets.getSkin(i));
+        targetInstances.push_back(instance);
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    int texLoc = glGetUniformLocation(cylinderShaderProgram, "uTexture");
-    glUniform1i(texLoc, 0);
+    if (targetInstances.empty()) {
+        return;
+    }
 
-    glBindVertexArray(cylinderVAO);
-    glDrawElements(GL_TRIANGLES, 32 * 3 + 32 * 3 + 32 * 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    // Re-specify (orphan) the storage each frame so the upload never waits on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, targetInstanceVBO);
+    targetInstanceCapacity = std::max(targetInstanceCapacity, targetInstances.capacity());
+    glBufferData(GL_ARRAY_BUFFER, targetInstanceCapacity * sizeof(TargetInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, targetInstances.size() * sizeof(TargetInstance), targetInstances.data());
+
+    DrawCommand command;
+    command.pass = RenderPass::Translucent;
+    command.program = cylinderShaderProgram;
+    command.vao = cylinderVAO;
+    command.textureTarget = GL_TEXTURE_2D_ARRAY;
+    command.textureUnit = 1;
+    command.texture = targetSkinArray;
+    command.indexCount = 32 * 3 + 32 * 3 + 32 * 6;
+    command.instanceCount = static_cast<int>(targetInstances.size());
+    command.intLoc = cylinderInstancedLoc;
+    command.intValue = 1;
+    command.gpuZone = static_cast<int>(GpuZone::Targets);
+    drawQueue.push(command, 0.0f);
 }
 
 void AimTrainer::initRoom() {
@@ -970,6 +839,14 @@ void AimTrainer::initRoom() {
         -halfWidth, halfHeight,  halfDepth,  0.0f, -1.0f, 0.0f,  0.0f, texScaleD,
     };
 
+    // Same order as the index ranges below, drawRoom sorts the faces by distance to these
+    roomFaceCenters[0] = glm::vec3(0.0f, 0.0f, -halfDepth);
+    roomFaceCenters[1] = glm::vec3(0.0f, 0.0f, halfDepth);
+    roomFaceCenters[2] = glm::vec3(-halfWidth, 0.0f, 0.0f);
+    roomFaceCenters[3] = glm::vec3(halfWidth, 0.0f, 0.0f);
+    roomFaceCenters[4] = glm::vec3(0.0f, -halfHeight, 0.0f);
+    roomFaceCenters[5] = glm::vec3(0.0f, halfHeight, 0.0f);
+
     std::vector<unsigned int> indices = {
         0, 1, 2, 0, 2, 3,       // Front wall
         4, 5, 6, 4, 6, 7,       // Back wall
@@ -983,7 +860,7 @@ void AimTrainer::initRoom() {
     glGenBuffers(1, &roomVBO);
     glGenBuffers(1, &roomEBO);
 
-    glBindVertexArray(roomVAO);
+    RenderState::bindVertexArray(roomVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, roomVBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
@@ -1000,58 +877,26 @@ void AimTrainer::initRoom() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    glBindVertexArray(0);
+    RenderState::bindVertexArray(0);
 }
 
 void AimTrainer::drawRoom() {
-    glUseProgram(roomShaderProgram);
-
-    glm::mat4 view = camera->getViewMatrix();
-    float aspect = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
-    glm::mat4 projection = camera->getProjectionMatrix(aspect);
-
-    int viewLoc = glGetUniformLocation(roomShaderProgram, "uView");
-    int projLoc = glGetUniformLocation(roomShaderProgram, "uProjection");
-    int modelLoc = glGetUniformLocation(roomShaderProgram, "uModel");
-    int wallColorLoc = glGetUniformLocation(roomShaderProgram, "uWallColor");
-    int useTextureLoc = glGetUniformLocation(roomShaderProgram, "uUseTexture");
-    int lightPosLoc = glGetUniformLocation(roomShaderProgram, "uLightPos");
-    int viewPosLoc = glGetUniformLocation(roomShaderProgram, "uViewPos");
-    int texLoc = glGetUniformLocation(roomShaderProgram, "uWallTexture");
-
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-    glm::vec3 lightPos(0.0f, 4.0f, 0.0f);
-    glUniform3fv(lightPosLoc, 1, glm::value_ptr(lightPos));
-    glUniform3fv(viewPosLoc, 1, glm::value_ptr(camera->getPosition()));
-
-    glm::mat4 model = glm::mat4(1.0f);
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-    glBindVertexArray(roomVAO);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, wallTexture);
-    glUniform1i(texLoc, 0);
-    glm::vec3 wallColor(0.8f, 0.8f, 0.8f);
-    glUniform3fv(wallColorLoc, 1, glm::value_ptr(wallColor));
-    glUniform1i(useTextureLoc, 1);
-
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(6 * sizeof(unsigned int)));
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(12 * sizeof(unsigned int)));
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(18 * sizeof(unsigned int)));
-
-    glBindTexture(GL_TEXTURE_2D, floorTexture);
-    glUniform1i(texLoc, 0);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(24 * sizeof(unsigned int)));
-
-    glBindTexture(GL_TEXTURE_2D, ceilingTexture);
-    glUniform1i(texLoc, 0);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(30 * sizeof(unsigned int)));
-
-    glBindVertexArray(0);
+    PROFILE_ZONE("AimTrainer::drawRoom");
+    // Front, back, left and right walls share one texture, then floor and ceiling
+    unsigned int faceTextures[6] = { wallTexture, wallTexture, wallTexture, wallTexture, floorTexture, ceilingTexture };
+    glm::vec3 cameraPosition = simulation.getCamera().getPosition();
+
+    DrawCommand command;
+    command.pass = RenderPass::Opaque;
+    command.program = roomShaderProgram;
+    command.vao = roomVAO;
+    command.indexCount = 6;
+    command.gpuZone = static_cast<int>(GpuZone::Room);
+    for (int face = 0; face < 6; face++) {
+        command.texture = faceTextures[face];
+        command.firstIndex = face * 6;
+        drawQueue.push(command, glm::length(roomFaceCenters[face] - cameraPosition));
+    }
 }
 
 void AimTrainer::initLight() {
@@ -1108,7 +953,7 @@ void AimTrainer::initLight() {
     glGenBuffers(1, &lightVBO);
     glGenBuffers(1, &lightEBO);
 
-    glBindVertexArray(lightVAO);
+    RenderState::bindVertexArray(lightVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, lightVBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
@@ -1122,46 +967,31 @@ void AimTrainer::initLight() {
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
+    RenderState::bindVertexArray(0);
 }
 
 void AimTrainer::initWallWeapons() {
     std::cout << "=== INITIALIZING WALL WEAPONS ===" << std::endl;
 
-    WallWeapon testAK;
-    if (OBJLoader::loadOBJ("obj/ak47.obj", testAK.mesh)) {
-        OBJLoader::setupMesh(testAK.mesh);
-        testAK.mesh.texture = loadImageToTexture("obj/weapon_rif_ak47.png");
-
-        testAK.position = glm::vec3(7.0f, -3.5f, -9.5f);
-        testAK.rotation = glm::vec3(0.0f, glm::radians(180.0f), glm::radians(90.0f));
-        testAK.scale = glm::vec3(150.0f, 150.0f, 150.0f);
-        testAK.isAK = true;
-        wallWeapons.push_back(testAK);
-
-        std::cout << "✓ AK-47 mounted on BOTTOM RIGHT corner!" << std::endl;
-        std::cout << "  Position: (" << testAK.position.x << ", " << testAK.position.y << ", " << testAK.position.z << ")" << std::endl;
-    }
-    else {
-        std::cout << "✗ FAILED to load AK-47 model!" << std::endl;
-    }
-
-    WallWeapon testUSP;
-    if (OBJLoader::loadOBJ("obj2/usp.obj", testUSP.mesh)) {
-        OBJLoader::setupMesh(testUSP.mesh);
-        testUSP.mesh.texture = loadImageToTexture("obj2/weapon_pist_usp_silencer.png");
+    // Placement comes from the simulation, which owns the pickup hitboxes
+    for (const WeaponPickup& pickup : simulation.getWeaponPickups()) {
+        const char* name = pickup.isAK ? "AK-47" : "USP-S";
+        WallWeapon weapon;
+        if (!OBJLoader::loadOBJ(pickup.isAK ? "obj/ak47.obj" : "obj2/usp.obj", weapon.mesh)) {
+            std::cout << "✗ FAILED to load " << name << " model!" << std::endl;
+            continue;
+        }
+        OBJLoader::setupMesh(weapon.mesh);
+        weapon.mesh.texture = loadImageToTexture(pickup.isAK ? "obj/weapon_rif_ak47.png" : "obj2/weapon_pist_usp_silencer.png");
 
-        testUSP.position = glm::vec3(-8.5f, -3.5f, -9.5f);
-        testUSP.rotation = glm::vec3(0.0f, glm::radians(180.0f), glm::radians(90.0f));
-        testUSP.scale = glm::vec3(150.0f, 150.0f, 150.0f);
-        testUSP.isAK = false;
-        wallWeapons.push_back(testUSP);
+        weapon.position = pickup.position;
+        weapon.rotation = glm::vec3(0.0f, glm::radians(180.0f), glm::radians(90.0f));
+        weapon.scale = pickup.scale;
+        weapon.isAK = pickup.isAK;
+        wallWeapons.push_back(weapon);
 
-        std::cout << "✓ USP-S mounted on BOTTOM LEFT corner!" << std::endl;
-        std::cout << "  Position: (" << testUSP.position.x << ", " << testUSP.position.y << ", " << testUSP.position.z << ")" << std::endl;
-    }
-    else {
-        std::cout << "✗ FAILED to load USP model!" << std::endl;
+        std::cout << "✓ " << name << " mounted on BOTTOM " << (pickup.isAK ? "RIGHT" : "LEFT") << " corner!" << std::endl;
+        std::cout << "  Position: (" << weapon.position.x << ", " << weapon.position.y << ", " << weapon.position.z << ")" << std::endl;
     }
 
     std::cout << "Total wall weapons: " << wallWeapons.size() << std::endl;
@@ -1169,127 +999,56 @@ void AimTrainer::initWallWeapons() {
 }
 
 void AimTrainer::drawWallWeapons() {
-    if (wallWeapons.empty()) {
-        return;
-    }
-
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glUseProgram(weaponShaderProgram);
-
-    glm::mat4 view = camera->getViewMatrix();
-    float aspect = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
-
-    int viewLoc = glGetUniformLocation(weaponShaderProgram, "uView");
-    int projLoc = glGetUniformLocation(weaponShaderProgram, "uProjection");
-
-    if (viewLoc == -1 || projLoc == -1) {
-        std::cout << "ERROR: Shader uniforms not found!" << std::endl;
+    PROFILE_ZONE("AimTrainer::drawWallWeapons");
+    if (weaponModelLoc == -1) {
         return;
     }
 
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-    glm::vec3 lightPos(0.0f, 4.0f, 0.0f);
-    int lightPosLoc = glGetUniformLocation(weaponShaderProgram, "uLightPos");
-    if (lightPosLoc != -1) {
-        glUniform3fv(lightPosLoc, 1, glm::value_ptr(lightPos));
-    }
-
-    int viewPosLoc = glGetUniformLocation(weaponShaderProgram, "uViewPos");
-    if (viewPosLoc != -1) {
-        glUniform3fv(viewPosLoc, 1, glm::value_ptr(camera->getPosition()));
-    }
-
-    float currentTime = static_cast<float>(glfwGetTime());
-    int timeLoc = glGetUniformLocation(weaponShaderProgram, "uTime");
-    if (timeLoc != -1) {
-        glUniform1f(timeLoc, currentTime);
-    }
-
+    glm::vec3 cameraPosition = simulation.getCamera().getPosition();
     for (const auto& weapon : wallWeapons) {
-        drawWeaponMesh(weapon);
-    }
-
-    if (depthTestEnabled) glEnable(GL_DEPTH_TEST);
-    if (faceCullingEnabled) glEnable(GL_CULL_FACE);
-}
-
-void AimTrainer::drawWeaponMesh(const WallWeapon& weapon) {
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, weapon.position);
-    model = glm::rotate(model, weapon.rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::rotate(model, weapon.rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::rotate(model, weapon.rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::scale(model, weapon.scale);
-
-    int modelLoc = glGetUniformLocation(weaponShaderProgram, "uModel");
-    if (modelLoc == -1) {
-        return;
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, weapon.position);
+        model = glm::rotate(model, weapon.rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
+        model = glm::rotate(model, weapon.rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::rotate(model, weapon.rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, weapon.scale);
+
+        DrawCommand command;
+        command.pass = RenderPass::OpaqueTwoSided;
+        command.program = weaponShaderProgram;
+        command.vao = weapon.mesh.VAO;
+        command.texture = weapon.mesh.texture;
+        command.indexCount = weapon.mesh.indexCount;
+        command.modelLoc = weaponModelLoc;
+        command.intLoc = weaponInstancedLoc;
+        command.intValue = 0;
+        command.gpuZone = static_cast<int>(GpuZone::Weapons);
+        drawQueue.push(command, glm::length(weapon.position - cameraPosition), model);
     }
-
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-    if (weapon.mesh.texture != 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, weapon.mesh.texture);
-        int texLoc = glGetUniformLocation(weaponShaderProgram, "uTexture");
-        if (texLoc != -1) {
-            glUniform1i(texLoc, 0);
-        }
-    }
-
-    glBindVertexArray(weapon.mesh.VAO);
-    glDrawElements(GL_TRIANGLES, weapon.mesh.indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 void AimTrainer::drawLight() {
-    glUseProgram(lightShaderProgram);
-
-    glm::vec3 lightPosition(0.0f, 4.5f, 0.0f);
-
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, lightPosition);
-
-    glm::mat4 view = camera->getViewMatrix();
-    float aspect = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
-    glm::mat4 projection = camera->getProjectionMatrix(aspect);
-
-    int modelLoc = glGetUniformLocation(lightShaderProgram, "uModel");
-    int viewLoc = glGetUniformLocation(lightShaderProgram, "uView");
-    int projLoc = glGetUniformLocation(lightShaderProgram, "uProjection");
-
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-    glm::vec3 lightColor(1.0f, 0.95f, 0.8f);
-    int colorLoc = glGetUniformLocation(lightShaderProgram, "uLightColor");
-    glUniform3fv(colorLoc, 1, glm::value_ptr(lightColor));
-
-    float intensity = 2.0f;
-    int intensityLoc = glGetUniformLocation(lightShaderProgram, "uIntensity");
-    glUniform1f(intensityLoc, intensity);
-
-    glBindVertexArray(lightVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    PROFILE_ZONE("AimTrainer::drawLight");
+    // Lamp mesh hangs half a unit above the point it lights from
+    glm::vec3 lampPosition = lightPosition + glm::vec3(0.0f, 0.5f, 0.0f);
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), lampPosition);
+
+    DrawCommand command;
+    command.pass = RenderPass::Opaque;
+    command.program = lightShaderProgram;
+    command.vao = lightVAO;
+    command.indexCount = 36;
+    command.modelLoc = lightModelLoc;
+    command.gpuZone = static_cast<int>(GpuZone::Light);
+    drawQueue.push(command, glm::length(lampPosition - simulation.getCamera().getPosition()), model);
 }
 
 void AimTrainer::toggleDepthTest() {
     depthTestEnabled = !depthTestEnabled;
     if (depthTestEnabled) {
-        glEnable(GL_DEPTH_TEST);
         std::cout << "\n[DEPTH TEST] ✓ ENABLED - Pravilna dubina objekata" << std::endl;
     }
     else {
-        glDisable(GL_DEPTH_TEST);
         std::cout << "\n[DEPTH TEST] ✗ DISABLED - Mozes vidjeti rendering bugove!" << std::endl;
     }
 }
@@ -1297,44 +1056,13 @@ void AimTrainer::toggleDepthTest() {
 void AimTrainer::toggleFaceCulling() {
     faceCullingEnabled = !faceCullingEnabled;
     if (faceCullingEnabled) {
-        glEnable(GL_CULL_FACE);
         std::cout << "\n[FACE CULLING] ✓ ENABLED - Samo prednje strane su vidljive" << std::endl;
     }
     else {
-        glDisable(GL_CULL_FACE);
         std::cout << "\n[FACE CULLING] ✗ DISABLED - Obje strane su vidljive (slower)" << std::endl;
     }
 }
 
-void AimTrainer::processMouseMovement(float xoffset, float yoffset) {
-    if (!gameOver && camera) {
-        camera->processMouseMovement(xoffset, yoffset);
-    }
-}
-
-bool AimTrainer::raySphereIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
-    const glm::vec3& sphereCenter, float sphereRadius) {
-    glm::vec3 oc = rayOrigin - sphereCenter;
-    float a = glm::dot(rayDir, rayDir);
-    float b = 2.0f * glm::dot(oc, rayDir);
-    float c = glm::dot(oc, oc) - sphereRadius * sphereRadius;
-    float discriminant = b * b - 4 * a * c;
-
-    return discriminant >= 0.0f;
-}
-
-bool AimTrainer::rayAABBIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
-    const glm::vec3& boxMin, const glm::vec3& boxMax) {
-    glm::vec3 invDir = glm::vec3(1.0f) / rayDir;
-
-    glm::vec3 t0 = (boxMin - rayOrigin) * invDir;
-    glm::vec3 t1 = (boxMax - rayOrigin) * invDir;
-
-    glm::vec3 tmin = glm::min(t0, t1);
-    glm::vec3 tmax = glm::max(t0, t1);
-
-    float tNear = glm::max(glm::max(tmin.x, tmin.y), tmin.z);
-    float tFar = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
-
-    return tNear <= tFar && tFar >= 0.0f;
+void AimTrainer::processMouseMovement(float xoffset, float yoffset, uint64_t timeNs) {
+    simulation.look(xoffset, yoffset, timeNs);
 }
\ No newline at end of file
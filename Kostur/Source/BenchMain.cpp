@@ -0,0 +1,695 @@
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "../Header/AimTrainer.h"
+#include "../Header/Simulation.h"
+#include "../Header/RenderState.h"
+#include "../Header/Profiler.h"
+#include "../Header/GLStats.h"
+#include "../Header/TraceCapture.h"
+#include "../Header/InputRecording.h"
+#include "../Header/TargetPool.h"
+#include "../Header/RayPick.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Headless benchmark: drives AimTrainer in an offscreen EGL context with
+// scripted input and prints per-frame CPU/GPU cost percentiles as JSON, along
+// with how many GL state changes RenderState issued and dropped per frame.
+// --sim-only N skips OpenGL and runs N ticks of the bare Simulation on a
+// manual clock instead; the state hash it prints repeats for the same options.
+// --ticks-per-frame N runs its ticks in frames of N, the clock and the input
+// moving once per frame as in the game, aims at the target about to run out,
+// and fails if a shot from a later tick hit a target an earlier one expired.
+// --record saves the scripted run as an input recording, --replay drives the
+// frames from a recording (the game's or the bench's) instead of the script.
+// --pool-stress N measures the target pool alone: N short-lived targets aged
+// and refilled every tick, for --frames ticks. --pick-bench compares the
+// vectorized nearest-target ray test with the scalar one and the grid-indexed
+// one at 10, 1k and 100k targets.
+
+struct BenchOptions {
+    int frames = 1000;
+    int warmup = 60;
+    int width = 1920;
+    int height = 1080;
+    float deltaTime = 1.0f / 75.0f;
+    std::string root = KOSTUR_DATA_DIR;
+    std::string outPath;
+    std::string capturePath;
+    std::string tracePath;
+    bool overlay = false;
+    uint64_t seed = 1;
+    long long simTicks = 0;  // > 0: Simulation only, no context
+    int ticksPerFrame = 1;
+    std::string recordPath;
+    std::string replayPath;  // stops early when the recording ends
+    int poolTargets = 0;  // > 0: TargetPool stress only, no context
+    bool pickBench = false;
+};
+
+struct Percentiles {
+    double mean, p50, p90, p99, max;
+};
+
+static void printUsage() {
+    std::printf("Usage: aimtrainer_bench [--frames N] [--warmup N] [--width W] [--height H]\n"
+                "                        [--dt SECONDS] [--root DIR] [--out FILE] [--capture FILE.ppm]\n"
+                "                        [--overlay] [--trace FILE.json] [--seed N] [--sim-only TICKS]\n"
+                "                        [--ticks-per-frame N] [--record FILE] [--replay FILE] [--pool-stress TARGETS]\n"
+                "                        [--pick-bench]\n");
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--frames" && hasValue) options.frames = std::atoi(argv[++i]);
+        else if (arg == "--warmup" && hasValue) options.warmup = std::atoi(argv[++i]);
+        else if (arg == "--width" && hasValue) options.width = std::atoi(argv[++i]);
+        else if (arg == "--height" && hasValue) options.height = std::atoi(argv[++i]);
+        else if (arg == "--dt" && hasValue) options.deltaTime = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--root" && hasValue) options.root = argv[++i];
+        else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+        else if (arg == "--capture" && hasValue) options.capturePath = argv[++i];
+        else if (arg == "--trace" && hasValue) options.tracePath = argv[++i];
+        else if (arg == "--overlay") options.overlay = true;
+        else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--sim-only" && hasValue) options.simTicks = std::atoll(argv[++i]);
+        else if (arg == "--ticks-per-frame" && hasValue) options.ticksPerFrame = std::atoi(argv[++i]);
+        else if (arg == "--record" && hasValue) options.recordPath = argv[++i];
+        else if (arg == "--replay" && hasValue) options.replayPath = argv[++i];
+        else if (arg == "--pool-stress" && hasValue) options.poolTargets = std::atoi(argv[++i]);
+        else if (arg == "--pick-bench") options.pickBench = true;
+        else {
+            printUsage();
+            return false;
+        }
+    }
+    return options.frames > 0 && options.width > 0 && options.height > 0 && options.simTicks >= 0 && options.poolTargets >= 0 && options.deltaTime > 0.0f
+        && options.ticksPerFrame > 0;
+}
+
+static bool createHeadlessContext(EGLDisplay& display, EGLContext& context) {
+    display = EGL_NO_DISPLAY;
+
+    // Prefer Mesa's surfaceless platform so no X/Wayland server is needed
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::fprintf(stderr, "EGL display could not be initialized\n");
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        std::fprintf(stderr, "No EGL config with desktop OpenGL support\n");
+        return false;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::fprintf(stderr, "OpenGL 3.3 core context could not be created (0x%x)\n", eglGetError());
+        return false;
+    }
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::fprintf(stderr, "Surfaceless eglMakeCurrent failed (0x%x)\n", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+static void createFramebuffer(int width, int height, unsigned int& fbo, unsigned int& colorRbo, unsigned int& depthRbo) {
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorRbo);
+    glGenRenderbuffers(1, &depthRbo);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRbo);
+    glViewport(0, 0, width, height);
+}
+
+// Same path as the game's input: recorded, then applied
+static void dispatchInput(AimTrainer& game, InputRecorder& recorder, const InputEvent& event) {
+    recorder.record(event);
+    game.applyInput(event);
+}
+
+// Deterministic sweep with periodic clicks, AK-47 for the middle third of the run
+static void applyScriptedInput(AimTrainer& game, InputRecorder& recorder, int frame, int totalFrames) {
+    uint64_t now = Profiler::nowNs();
+    float xoffset = 9.0f * std::sin(frame * 0.045f);
+    float yoffset = 4.0f * std::cos(frame * 0.031f);
+    dispatchInput(game, recorder, InputEvent::motion(now, xoffset, yoffset));
+
+    if (frame == totalFrames / 3) dispatchInput(game, recorder, InputEvent::keyPress(now, GLFW_KEY_1));
+    if (frame == 2 * totalFrames / 3) dispatchInput(game, recorder, InputEvent::keyPress(now, GLFW_KEY_2));
+
+    int phase = frame % 15;
+    if (phase == 0) dispatchInput(game, recorder, InputEvent::buttonDown(now, 0.0f, 0.0f));
+    else if (phase == 4) dispatchInput(game, recorder, InputEvent::buttonUp(now));
+
+    if (game.isGameOver()) {
+        dispatchInput(game, recorder, InputEvent::keyPress(now, GLFW_KEY_R));
+    }
+}
+
+// The same script for the bare simulation; input lands at the start of the frame
+static void applyScriptedInput(Simulation& simulation, long long frame, long long totalFrames) {
+    float xoffset = 9.0f * std::sin(frame * 0.045f);
+    float yoffset = 4.0f * std::cos(frame * 0.031f);
+    simulation.look(xoffset, yoffset);
+
+    if (frame == totalFrames / 3) simulation.setFireMode(FireMode::AK47);
+    if (frame == 2 * totalFrames / 3) simulation.setFireMode(FireMode::USP);
+
+    int phase = static_cast<int>(frame % 15);
+    if (phase == 0) {
+        simulation.pressTrigger();
+        simulation.click();
+    }
+    else if (phase == 4) simulation.releaseTrigger();
+}
+
+// Turns the camera towards a target that runs out within the next frameSeconds,
+// so held full-auto fire lands on targets around the moment they expire
+static void trackExpiringTarget(Simulation& simulation, float frameSeconds) {
+    const TargetPool& targets = simulation.getTargets();
+    int soonest = -1;
+    for (int t = 0; t < targets.size(); t++) {
+        if (targets.getLifeTime(t) < frameSeconds && (soonest < 0 || targets.getLifeTime(t) < targets.getLifeTime(soonest))) soonest = t;
+    }
+    if (soonest < 0) return;
+    const Camera& camera = simulation.getCamera();
+    glm::vec3 direction = glm::normalize(targets.getPosition(soonest) - camera.getPosition());
+    float yaw = glm::degrees(std::atan2(direction.z, direction.x));
+    float pitch = glm::degrees(std::asin(direction.y));
+    float yawOffset = std::remainder(yaw - camera.getYaw(), 360.0f);
+    simulation.look(yawOffset / camera.getMouseSensitivity(), (pitch - camera.getPitch()) / camera.getMouseSensitivity());
+}
+
+static FILE* openOutput(const BenchOptions& options) {
+    if (options.outPath.empty()) return stdout;
+    FILE* out = std::fopen(options.outPath.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "Could not open %s for writing\n", options.outPath.c_str());
+        return stdout;
+    }
+    return out;
+}
+
+// Tens of thousands of targets living a few ticks each: nearly all the time goes
+// to the lifetime pass, expiry and compaction
+static int runPoolStress(const BenchOptions& options) {
+    Pcg32 random(options.seed);
+    TargetPool pool(options.poolTargets, Simulation::ROOM_HALF_WIDTH, Simulation::ROOM_HALF_HEIGHT, Simulation::ROOM_HALF_DEPTH);
+    auto refill = [&]() {
+        while (pool.size() < options.poolTargets) {
+            glm::vec3 position(random.nextSigned() * 10.0f, random.nextSigned() * 5.0f, -9.5f);
+            float lifeTime = (0.5f + random.nextFloat() * 4.5f) * options.deltaTime * 4.0f;
+            pool.add(position, 1.0f, lifeTime, static_cast<int>(random.nextBelow(2)), 0);
+        }
+    };
+    refill();
+
+    long long expired = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < options.frames; tick++) {
+        expired += pool.age(options.deltaTime);
+        pool.removeExpired();
+        refill();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    FILE* out = openOutput(options);
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"mode\": \"pool_stress\",\n");
+    std::fprintf(out, "  \"targets\": %d,\n", options.poolTargets);
+    std::fprintf(out, "  \"ticks\": %d,\n", options.frames);
+    std::fprintf(out, "  \"seconds\": %.4f,\n", seconds);
+    std::fprintf(out, "  \"us_per_tick\": %.3f,\n", seconds * 1e6 / options.frames);
+    std::fprintf(out, "  \"expired_per_tick\": %.1f,\n", static_cast<double>(expired) / options.frames);
+    std::fprintf(out, "  \"ns_per_target\": %.3f\n", seconds * 1e9 / (static_cast<double>(options.frames) * options.poolTargets));
+    std::fprintf(out, "}\n");
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
+
+// Targets scattered over the four walls as spawnTarget() places them, rays from the
+// camera spread over the front half of the room
+static int runPickBench(const BenchOptions& options) {
+    const int targetCounts[] = { 10, 1000, 100000 };
+    const int RAYS = 16;
+    glm::vec3 origin(0.0f, 0.0f, 3.0f);
+
+    FILE* out = openOutput(options);
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"mode\": \"pick_bench\",\n");
+    std::fprintf(out, "  \"results\": [\n");
+    int totalMismatches = 0;
+    for (int c = 0; c < 3; c++) {
+        int targetCount = targetCounts[c];
+        Pcg32 random(options.seed);
+        TargetPool pool(targetCount, Simulation::ROOM_HALF_WIDTH, Simulation::ROOM_HALF_HEIGHT, Simulation::ROOM_HALF_DEPTH);
+        for (int i = 0; i < targetCount; i++) {
+            glm::vec3 position;
+            switch (random.nextBelow(4)) {
+            case 0: position = glm::vec3(random.nextSigned() * 6.5f, random.nextSigned() * 1.5f, -9.5f); break;
+            case 1: position = glm::vec3(random.nextSigned() * 6.5f, random.nextSigned() * 1.5f, 9.5f); break;
+            case 2: position = glm::vec3(-9.5f, random.nextSigned() * 1.5f, random.nextSigned() * 6.5f); break;
+            default: position = glm::vec3(9.5f, random.nextSigned() * 1.5f, random.nextSigned() * 6.5f); break;
+            }
+            pool.add(position, 1.0f, 1.0f, 0, 0);
+        }
+        std::vector<glm::vec3> directions(RAYS * 64);
+        for (glm::vec3& direction : directions) {
+            direction = glm::normalize(glm::vec3(random.nextSigned() * 0.7f, random.nextSigned() * 0.2f, -1.0f));
+        }
+
+        // About 20M target tests per variant
+        int passes = std::max(1, 20000000 / (targetCount * static_cast<int>(directions.size())));
+        int rayCount = static_cast<int>(directions.size());
+        std::vector<RayPick::Hit> scalarHits(rayCount), vectorHits(rayCount), batchHits(rayCount), gridHits(rayCount);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (int r = 0; r < rayCount; r++) {
+                scalarHits[r] = RayPick::nearestScalar(pool, origin, directions[r], RayPick::Shape::Disc);
+            }
+        }
+        double scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (int r = 0; r < rayCount; r++) {
+                vectorHits[r] = RayPick::nearest(pool, origin, directions[r], RayPick::Shape::Disc);
+            }
+        }
+        double vectorSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            RayPick::nearestMany(pool, origin, directions.data(), nullptr, rayCount, RayPick::Shape::Disc, batchHits.data());
+        }
+        double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (int r = 0; r < rayCount; r++) {
+                gridHits[r] = RayPick::nearestIndexed(pool, origin, directions[r], RayPick::Shape::Disc);
+            }
+        }
+        double gridSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int mismatches = 0;
+        int hits = 0;
+        for (int r = 0; r < rayCount; r++) {
+            if (scalarHits[r].index != vectorHits[r].index || scalarHits[r].index != batchHits[r].index
+                || scalarHits[r].index != gridHits[r].index || scalarHits[r].t != vectorHits[r].t
+                || scalarHits[r].t != batchHits[r].t || scalarHits[r].t != gridHits[r].t) {
+                mismatches++;
+            }
+            if (scalarHits[r].index >= 0) hits++;
+        }
+        totalMismatches += mismatches;
+
+        double rays = static_cast<double>(passes) * rayCount;
+        std::fprintf(out, "    { \"targets\": %d, \"rays\": %.0f, \"hits_per_pass\": %d, \"mismatches\": %d,\n",
+            targetCount, rays, hits, mismatches);
+        std::fprintf(out, "      \"scalar_ns_per_ray\": %.1f, \"simd_ns_per_ray\": %.1f, \"simd_batch16_ns_per_ray\": %.1f, \"grid_ns_per_ray\": %.1f }%s\n",
+            scalarSeconds * 1e9 / rays, vectorSeconds * 1e9 / rays, batchSeconds * 1e9 / rays, gridSeconds * 1e9 / rays,
+            c < 2 ? "," : "");
+    }
+    std::fprintf(out, "  ]\n");
+    std::fprintf(out, "}\n");
+    if (out != stdout) std::fclose(out);
+
+    // The variants must agree exactly, or the faster ones are not drop-in replacements
+    if (totalMismatches > 0) {
+        std::fprintf(stderr, "%d rays picked differently between variants\n", totalMismatches);
+        return 1;
+    }
+    return 0;
+}
+
+static int runSimulationOnly(const BenchOptions& options) {
+    ManualClock clock;
+    Simulation simulation(clock, options.seed);
+    simulation.setLogging(false);
+    uint64_t tickNs = static_cast<uint64_t>(options.deltaTime * 1e9);
+
+    long long games = 1;
+    long long totalHits = 0;
+    long long totalShots = 0;
+    long long staleHits = 0;
+    long long totalFrames = (options.simTicks + options.ticksPerFrame - 1) / options.ticksPerFrame;
+    auto start = std::chrono::steady_clock::now();
+    for (long long tick = 0; tick < options.simTicks; tick++) {
+        if (tick % options.ticksPerFrame == 0) {
+            if (simulation.isGameOver()) {
+                totalHits += simulation.getScore();
+                totalShots += simulation.getTotalClicks();
+                simulation.restart();
+                games++;
+            }
+            applyScriptedInput(simulation, tick / options.ticksPerFrame, totalFrames);
+            if (options.ticksPerFrame > 1) trackExpiringTarget(simulation, options.deltaTime * options.ticksPerFrame);
+            clock.advance(tickNs * options.ticksPerFrame);
+        }
+        // Shots fired inside tick() come after everything earlier ticks expired,
+        // so none of them may be a late hit
+        int lateHits = simulation.getLateHits();
+        simulation.tick(options.deltaTime);
+        if (simulation.getLateHits() > lateHits) {
+            staleHits += simulation.getLateHits() - lateHits;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    totalHits += simulation.getScore();
+    totalShots += simulation.getTotalClicks();
+
+    FILE* out = openOutput(options);
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"mode\": \"sim_only\",\n");
+    std::fprintf(out, "  \"ticks\": %lld,\n", options.simTicks);
+    std::fprintf(out, "  \"ticks_per_frame\": %d,\n", options.ticksPerFrame);
+    std::fprintf(out, "  \"dt\": %.6f,\n", options.deltaTime);
+    std::fprintf(out, "  \"seed\": %llu,\n", static_cast<unsigned long long>(options.seed));
+    std::fprintf(out, "  \"seconds\": %.4f,\n", seconds);
+    std::fprintf(out, "  \"ticks_per_second\": %.0f,\n", seconds > 0.0 ? options.simTicks / seconds : 0.0);
+    std::fprintf(out, "  \"games\": %lld,\n", games);
+    std::fprintf(out, "  \"hits\": %lld,\n", totalHits);
+    std::fprintf(out, "  \"shots\": %lld,\n", totalShots);
+    std::fprintf(out, "  \"stale_hits\": %lld,\n", staleHits);
+    std::fprintf(out, "  \"state_hash\": \"%016llx\"\n", static_cast<unsigned long long>(simulation.stateHash()));
+    std::fprintf(out, "}\n");
+    if (out != stdout) std::fclose(out);
+
+    if (staleHits > 0) {
+        std::fprintf(stderr, "%lld shots hit targets an earlier tick had expired\n", staleHits);
+        return 1;
+    }
+    return 0;
+}
+
+// Writes the last rendered frame, handy for checking that headless output matches the game
+static bool writeFramePPM(const std::string& path, int width, int height) {
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (int row = height - 1; row >= 0; row--) {
+        std::fwrite(pixels.data() + static_cast<size_t>(row) * width * 3, 1, static_cast<size_t>(width) * 3, file);
+    }
+    std::fclose(file);
+    return true;
+}
+
+static Percentiles computePercentiles(std::vector<double> samples) {
+    Percentiles result = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if (samples.empty()) return result;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+
+    auto rank = [&samples](double p) {
+        size_t index = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::min(samples.size() - 1, index > 0 ? index - 1 : 0)];
+    };
+
+    result.mean = sum / samples.size();
+    result.p50 = rank(0.50);
+    result.p90 = rank(0.90);
+    result.p99 = rank(0.99);
+    result.max = samples.back();
+    return result;
+}
+
+static void writePercentiles(FILE* out, const char* name, const Percentiles& p, bool last) {
+    std::fprintf(out, "  \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+        name, p.mean, p.p50, p.p90, p.p99, p.max, last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) return 1;
+    if (options.pickBench) return runPickBench(options);
+    if (options.poolTargets > 0) return runPoolStress(options);
+    if (options.simTicks > 0) return runSimulationOnly(options);
+
+    // Game logging goes to stderr so stdout stays valid JSON
+    std::streambuf* coutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+    if (chdir(options.root.c_str()) != 0) {
+        std::fprintf(stderr, "Data directory not found: %s\n", options.root.c_str());
+        return 1;
+    }
+
+    // AimTrainer reads its clock through GLFW, the null platform needs no display
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit()) {
+        std::fprintf(stderr, "GLFW could not be initialized\n");
+        return 1;
+    }
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!createHeadlessContext(display, context)) {
+        glfwTerminate();
+        return 1;
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+    // GLEW built for GLX reports a missing X display even though the EGL context is usable
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY) {
+        std::fprintf(stderr, "GLEW could not be initialized\n");
+        return 1;
+    }
+    GLStats::install();
+
+    unsigned int fbo, colorRbo, depthRbo;
+    createFramebuffer(options.width, options.height, fbo, colorRbo, depthRbo);
+
+    RenderState::setEnabled(GL_BLEND, true);
+    RenderState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderState::setEnabled(GL_DEPTH_TEST, true);
+    RenderState::depthFunc(GL_LESS);
+    RenderState::setEnabled(GL_CULL_FACE, true);
+    RenderState::cullFace(GL_BACK);
+    RenderState::frontFace(GL_CCW);
+    glClearColor(0.15f, 0.15f, 0.2f, 1.0f);
+
+    InputPlayer player;
+    uint64_t seed = options.seed;
+    uint64_t startNs = Profiler::nowNs();
+    if (!options.replayPath.empty()) {
+        if (!player.open(options.replayPath)) return 1;
+        seed = player.getSeed();
+        startNs = player.getStartNs();
+    }
+
+    AimTrainer* game = new AimTrainer(options.width, options.height, seed, startNs);
+    game->setLatencyTracking(!player.isOpen());
+    InputRecorder recorder;
+    if (!options.recordPath.empty() && !recorder.start(options.recordPath, seed, startNs)) return 1;
+    if (options.overlay) {
+        game->toggleProfilerOverlay();
+    }
+
+    // Whole-frame GPU time from a pair of timestamps around the frame
+    unsigned int timerQueries[2];
+    glGenQueries(2, timerQueries);
+    game->getGpuProfiler()->setRecording(true);
+    TraceCapture traceCapture;
+
+    std::vector<double> cpuTimes, gpuTimes, frameTimes;
+    std::vector<double> stateIssued, stateElided;
+    cpuTimes.reserve(options.frames);
+    gpuTimes.reserve(options.frames);
+    frameTimes.reserve(options.frames);
+    stateIssued.reserve(options.frames);
+    stateElided.reserve(options.frames);
+
+    std::vector<InputEvent> replayEvents;
+    int totalFrames = options.warmup + options.frames;
+    for (int frame = 0; frame < totalFrames; frame++) {
+        if (player.isOpen() && !player.readFrame(replayEvents)) {
+            std::fprintf(stderr, "Recording ended after %d frames\n", frame);
+            break;
+        }
+        if (frame == options.warmup) {
+            GLStats::resetRun();
+            if (!options.tracePath.empty()) {
+                traceCapture.start(options.tracePath, options.frames, game->getGpuProfiler());
+            }
+        }
+        auto frameStart = std::chrono::steady_clock::now();
+
+        glQueryCounter(timerQueries[0], GL_TIMESTAMP);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (player.isOpen()) {
+            for (const InputEvent& event : replayEvents) {
+                dispatchInput(*game, recorder, event);
+            }
+        }
+        else {
+            dispatchInput(*game, recorder, InputEvent::frame(Profiler::nowNs()));
+            applyScriptedInput(*game, recorder, frame, totalFrames);
+            dispatchInput(*game, recorder, InputEvent::tick(options.deltaTime));
+        }
+        game->render();
+        game->getLatencyTracker().frameSubmitted();
+        glQueryCounter(timerQueries[1], GL_TIMESTAMP);
+        game->getLatencyTracker().frameSwapped();
+
+        auto cpuEnd = std::chrono::steady_clock::now();
+
+        // Stands in for the swap: the next frame starts once this one is on screen
+        glFinish();
+        auto frameEnd = std::chrono::steady_clock::now();
+        game->getLatencyTracker().poll();
+
+        GLuint64 gpuStart = 0, gpuEnd = 0;
+        glGetQueryObjectui64v(timerQueries[0], GL_QUERY_RESULT, &gpuStart);
+        glGetQueryObjectui64v(timerQueries[1], GL_QUERY_RESULT, &gpuEnd);
+        GLuint64 gpuNanoseconds = gpuEnd - gpuStart;
+        Profiler::endFrame();
+        GLStats::endFrame();
+        traceCapture.endFrame();
+
+        if (frame < options.warmup) continue;
+
+        cpuTimes.push_back(std::chrono::duration<double, std::milli>(cpuEnd - frameStart).count());
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+        gpuTimes.push_back(gpuNanoseconds / 1.0e6);
+
+        RenderState::Stats stateStats = RenderState::frameStats();
+        stateIssued.push_back(stateStats.issued);
+        stateElided.push_back(stateStats.elided);
+    }
+
+    FILE* out = openOutput(options);
+
+    if (!options.capturePath.empty() && !writeFramePPM(options.capturePath, options.width, options.height)) {
+        std::fprintf(stderr, "Could not write %s\n", options.capturePath.c_str());
+    }
+
+    // Ends before the GPU results of the last frames are read back
+    traceCapture.finish();
+    recorder.finish();
+    std::cout.rdbuf(coutBuffer);
+
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"renderer\": \"%s\",\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    std::fprintf(out, "  \"frames\": %d,\n", static_cast<int>(cpuTimes.size()));
+    std::fprintf(out, "  \"state_hash\": \"%016llx\",\n", static_cast<unsigned long long>(game->getSimulation().stateHash()));
+    std::fprintf(out, "  \"warmup\": %d,\n", options.warmup);
+    std::fprintf(out, "  \"width\": %d,\n", options.width);
+    std::fprintf(out, "  \"height\": %d,\n", options.height);
+    writePercentiles(out, "cpu_ms", computePercentiles(cpuTimes), false);
+    writePercentiles(out, "gpu_ms", computePercentiles(gpuTimes), false);
+    writePercentiles(out, "frame_ms", computePercentiles(frameTimes), false);
+    writePercentiles(out, "state_issued", computePercentiles(stateIssued), false);
+    writePercentiles(out, "state_elided", computePercentiles(stateElided), false);
+
+    // Zone history covers the last Profiler::HISTORY_FRAMES frames only
+    std::vector<Profiler::ZoneStats> zones;
+    Profiler::collect(zones);
+    std::fprintf(out, "  \"zones_ms\": {\n");
+    for (size_t i = 0; i < zones.size(); i++) {
+        std::fprintf(out, "    \"%s\": { \"min\": %.4f, \"avg\": %.4f, \"p99\": %.4f, \"calls\": %.2f }%s\n",
+            zones[i].name, zones[i].minMs, zones[i].avgMs, zones[i].p99Ms, zones[i].callsPerFrame,
+            i + 1 < zones.size() ? "," : "");
+    }
+    std::fprintf(out, "  },\n");
+
+    std::fprintf(out, "  \"gl_calls\": {\n");
+    for (int i = 0; i < GLStats::CounterCount; i++) {
+        GLStats::Counter counter = static_cast<GLStats::Counter>(i);
+        std::fprintf(out, "    \"%s\": { \"mean\": %.2f, \"max\": %llu },\n",
+            GLStats::counterName(counter), GLStats::runMean(counter), GLStats::runMax(counter));
+    }
+    std::fprintf(out, "    \"frames\": %lld\n  },\n", GLStats::runFrames());
+
+    // Scripted clicks are stamped right before handleMousePress, so hit is pure game-side cost
+    std::fprintf(out, "  \"latency_ms\": {\n");
+    for (int stage = 0; stage < LatencyTracker::StageCount; stage++) {
+        LatencyTracker::Stage latencyStage = static_cast<LatencyTracker::Stage>(stage);
+        LatencyTracker::Distribution latency = game->getLatencyTracker().distribution(latencyStage);
+        std::fprintf(out, "    \"click_to_%s\": { \"samples\": %d, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+            LatencyTracker::stageName(latencyStage), latency.samples, latency.p50Ms, latency.p90Ms, latency.p99Ms, latency.maxMs,
+            stage + 1 < LatencyTracker::StageCount ? "," : "");
+    }
+    std::fprintf(out, "  },\n");
+
+    // Per-pass GPU time; warmup frames are included, the readback lags by a few frames
+    GpuProfiler* gpuProfiler = game->getGpuProfiler();
+    std::fprintf(out, "  \"gpu_passes_ms\": {\n");
+    for (int zone = 0; zone < static_cast<int>(GpuZone::Count); zone++) {
+        const std::vector<float>& samples = gpuProfiler->getRunSamples(static_cast<GpuZone>(zone));
+        std::fprintf(out, "  ");
+        writePercentiles(out, GpuProfiler::zoneName(static_cast<GpuZone>(zone)),
+            computePercentiles(std::vector<double>(samples.begin(), samples.end())), zone + 1 == static_cast<int>(GpuZone::Count));
+    }
+    std::fprintf(out, "  }\n");
+    std::fprintf(out, "}\n");
+    if (out != stdout) std::fclose(out);
+
+    glDeleteQueries(2, timerQueries);
+    delete game;
+
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &colorRbo);
+    glDeleteRenderbuffers(1, &depthRbo);
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    glfwTerminate();
+    return 0;
+}
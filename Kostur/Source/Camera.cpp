@@ -64,12 +64,16 @@ void Camera::processMouseScroll(float yoffset) {
         zoom = 45.0f;
 }
 
-void Camera::updateCameraVectors() {
+glm::vec3 Camera::frontFromAngles(float yaw, float pitch) {
     glm::vec3 newFront;
     newFront.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
     newFront.y = sin(glm::radians(pitch));
     newFront.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-    front = glm::normalize(newFront);
+    return glm::normalize(newFront);
+}
+
+void Camera::updateCameraVectors() {
+    front = frontFromAngles(yaw, pitch);
 
     right = glm::normalize(glm::cross(front, worldUp));
     up = glm::normalize(glm::cross(right, front));
@@ -0,0 +1,167 @@
+#include "../Header/DrawQueue.h"
+#include "../Header/RenderState.h"
+#include "../Header/Profiler.h"
+#include "../Header/GLStats.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Field widths of the sort key, 62 of 64 bits used
+    const int PASS_BITS = 4;
+    const int PROGRAM_BITS = 10;
+    const int TEXTURE_BITS = 12;
+    const int VAO_BITS = 12;
+    const int DEPTH_BITS = 24;
+
+    uint64_t field(uint64_t value, int bits) {
+        return value & ((uint64_t(1) << bits) - 1);
+    }
+}
+
+DrawQueue::DrawQueue() {
+    for (PassState& state : passStates) {
+        state = { true, true, true };
+    }
+}
+
+void DrawQueue::setPassState(RenderPass pass, const PassState& state) {
+    passStates[static_cast<int>(pass)] = state;
+}
+
+void DrawQueue::clear() {
+    records.clear();
+    matrices.clear();
+    sortEntries.clear();
+}
+
+uint64_t DrawQueue::makeKey(const DrawCommand& command, float depth) {
+    float normalized = std::min(std::max(depth / MAX_SORT_DEPTH, 0.0f), 1.0f);
+    uint64_t depthBits = static_cast<uint64_t>(normalized * ((1u << DEPTH_BITS) - 1));
+
+    uint64_t pass = field(static_cast<uint64_t>(command.pass), PASS_BITS);
+    uint64_t program = field(command.program ? command.program->getId() : 0, PROGRAM_BITS);
+    uint64_t texture = field(command.texture, TEXTURE_BITS);
+    uint64_t vao = field(command.vao, VAO_BITS);
+
+    uint64_t key = pass;
+    if (command.pass == RenderPass::Translucent) {
+        // Far to near: invert depth and sort on it before any state
+        key = (key << DEPTH_BITS) | (((1u << DEPTH_BITS) - 1) - depthBits);
+        key = (key << PROGRAM_BITS) | program;
+        key = (key << TEXTURE_BITS) | texture;
+        key = (key << VAO_BITS) | vao;
+    }
+    else {
+        key = (key << PROGRAM_BITS) | program;
+        key = (key << TEXTURE_BITS) | texture;
+        key = (key << VAO_BITS) | vao;
+        key = (key << DEPTH_BITS) | depthBits;
+    }
+    return key;
+}
+
+void DrawQueue::push(const DrawCommand& command, float depth) {
+    records.push_back({ command, -1 });
+    sortEntries.push_back({ makeKey(command, depth), static_cast<uint32_t>(records.size() - 1) });
+}
+
+void DrawQueue::push(const DrawCommand& command, float depth, const glm::mat4& model) {
+    matrices.push_back(model);
+    records.push_back({ command, static_cast<int>(matrices.size()) - 1 });
+    sortEntries.push_back({ makeKey(command, depth), static_cast<uint32_t>(records.size() - 1) });
+}
+
+// LSD radix sort, one byte per pass. Bytes that are equal in every key are skipped;
+// with a few dozen draws most of the upper key bytes are.
+void DrawQueue::radixSort() {
+    size_t count = sortEntries.size();
+    sortScratch.resize(count);
+
+    SortEntry* source = sortEntries.data();
+    SortEntry* destination = sortScratch.data();
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t offsets[256];
+        std::memset(offsets, 0, sizeof(offsets));
+        for (size_t i = 0; i < count; i++) {
+            offsets[(source[i].key >> shift) & 0xFF]++;
+        }
+        if (offsets[(source[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        size_t total = 0;
+        for (size_t& offset : offsets) {
+            size_t bucket = offset;
+            offset = total;
+            total += bucket;
+        }
+        for (size_t i = 0; i < count; i++) {
+            destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+        }
+        std::swap(source, destination);
+    }
+
+    if (source != sortEntries.data()) {
+        std::memcpy(sortEntries.data(), source, count * sizeof(SortEntry));
+    }
+}
+
+void DrawQueue::submit(GpuProfiler* gpuProfiler) {
+    PROFILE_ZONE("DrawQueue::submit");
+    if (!sortEntries.empty()) {
+        radixSort();
+    }
+
+    int currentPass = -1;
+    int currentZone = -1;
+    for (const SortEntry& entry : sortEntries) {
+        const Record& record = records[entry.record];
+        const DrawCommand& command = record.command;
+
+        int pass = static_cast<int>(command.pass);
+        if (pass != currentPass) {
+            const PassState& state = passStates[pass];
+            RenderState::setEnabled(GL_DEPTH_TEST, state.depthTest);
+            RenderState::setEnabled(GL_CULL_FACE, state.cullFace);
+            RenderState::setEnabled(GL_BLEND, state.blend);
+            RenderState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            currentPass = pass;
+        }
+
+        if (gpuProfiler && command.gpuZone != currentZone) {
+            if (command.gpuZone >= 0) {
+                gpuProfiler->begin(static_cast<GpuZone>(command.gpuZone));
+            }
+            else {
+                gpuProfiler->end();
+            }
+            currentZone = command.gpuZone;
+        }
+
+        command.program->use();
+        if (record.matrixIndex >= 0 && command.modelLoc >= 0) {
+            command.program->setMat4(command.modelLoc, matrices[record.matrixIndex]);
+        }
+        if (command.intLoc >= 0) {
+            command.program->setInt(command.intLoc, command.intValue);
+        }
+        if (command.texture != 0) {
+            RenderState::bindTexture(command.textureUnit, command.textureTarget, command.texture);
+        }
+        RenderState::bindVertexArray(command.vao);
+
+        const void* indexOffset = reinterpret_cast<const void*>(static_cast<uintptr_t>(command.firstIndex) * sizeof(unsigned int));
+        if (command.instanceCount > 0) {
+            glDrawElementsInstanced(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT, indexOffset, command.instanceCount);
+        }
+        else {
+            glDrawElements(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT, indexOffset);
+            GLStats::countDraw(GL_TRIANGLES, command.indexCount);
+        }
+    }
+
+    if (gpuProfiler) {
+        gpuProfiler->end();
+    }
+    clear();
+}
@@ -0,0 +1,88 @@
+#include "../Header/FrameScheduler.h"
+#include "../Header/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+FrameScheduler::FrameScheduler(FrameMode mode, double targetFps, double simulationHz)
+    : mode(mode), framePeriod(1.0 / std::max(targetFps, 1.0)), step(1.0 / std::max(simulationHz, 1.0)),
+    accumulator(0.0), lastFrameTime(-1.0), nextFrameTime(0.0),
+    intervals(PACING_SAMPLES, 0.0), intervalCursor(0), intervalCount(0)
+{
+}
+
+void FrameScheduler::applySwapInterval() const {
+    glfwSwapInterval(mode == FrameMode::VSync ? 1 : 0);
+}
+
+void FrameScheduler::waitForFrame() {
+    PROFILE_ZONE("FrameScheduler::waitForFrame");
+    if (mode == FrameMode::Capped && lastFrameTime >= 0.0) {
+        // Sleep in the event wait so input still wakes us, then spin to the deadline
+        double remaining = nextFrameTime - glfwGetTime();
+        while (remaining > SPIN_SECONDS) {
+            glfwWaitEventsTimeout(remaining - SPIN_SECONDS);
+            remaining = nextFrameTime - glfwGetTime();
+        }
+        while (glfwGetTime() < nextFrameTime) {
+        }
+    }
+    glfwPollEvents();
+
+    double now = glfwGetTime();
+    if (lastFrameTime < 0.0) {
+        lastFrameTime = now;
+        nextFrameTime = now;
+    }
+    double delta = now - lastFrameTime;
+    lastFrameTime = now;
+
+    if (delta > 0.0) {
+        intervals[intervalCursor] = delta;
+        intervalCursor = (intervalCursor + 1) % PACING_SAMPLES;
+        intervalCount = std::min(intervalCount + 1, PACING_SAMPLES);
+    }
+
+    // Deadlines advance by whole periods so the cap does not drift; a missed
+    // frame restarts the schedule from now instead of bursting to catch up
+    nextFrameTime += framePeriod;
+    if (nextFrameTime < now) {
+        nextFrameTime = now + framePeriod;
+    }
+
+    accumulator = std::min(accumulator + delta, step * MAX_STEPS_PER_FRAME);
+}
+
+bool FrameScheduler::consumeStep() {
+    if (accumulator < step) {
+        return false;
+    }
+    accumulator -= step;
+    return true;
+}
+
+FramePacing FrameScheduler::getPacing() const {
+    FramePacing pacing = { 0.0, 0.0, 0.0, 0.0 };
+    if (intervalCount == 0) {
+        return pacing;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < intervalCount; i++) {
+        sum += intervals[i];
+    }
+    double mean = sum / intervalCount;
+
+    double variance = 0.0;
+    double maxDeviation = 0.0;
+    for (int i = 0; i < intervalCount; i++) {
+        double deviation = intervals[i] - mean;
+        variance += deviation * deviation;
+        maxDeviation = std::max(maxDeviation, std::fabs(deviation));
+    }
+
+    pacing.fps = 1.0 / mean;
+    pacing.meanMs = mean * 1000.0;
+    pacing.jitterMs = std::sqrt(variance / intervalCount) * 1000.0;
+    pacing.maxDeviationMs = maxDeviation * 1000.0;
+    return pacing;
+}
@@ -0,0 +1,200 @@
+#include "../Header/GLStats.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    GLStats::Counters frame = {};
+    GLStats::Counters last = {};
+    GLStats::Counters runTotals = {};
+    GLStats::Counters runMaxima = {};
+    long long runFrameCount = 0;
+    bool installed = false;
+
+#ifndef KOSTUR_NO_GL_STATS
+    unsigned long long trianglesFor(GLenum mode, GLsizei count) {
+        switch (mode) {
+        case GL_TRIANGLES: return count / 3;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN: return count > 2 ? count - 2 : 0;
+        default: return 0;
+        }
+    }
+
+    // Each hooked entry point keeps the driver's pointer and forwards to it
+    PFNGLUSEPROGRAMPROC realUseProgram = nullptr;
+    void GLAPIENTRY countedUseProgram(GLuint program) {
+        frame.values[GLStats::ProgramSwitches]++;
+        realUseProgram(program);
+    }
+
+    PFNGLGETUNIFORMLOCATIONPROC realGetUniformLocation = nullptr;
+    GLint GLAPIENTRY countedGetUniformLocation(GLuint program, const GLchar* name) {
+        frame.values[GLStats::UniformLookups]++;
+        return realGetUniformLocation(program, name);
+    }
+
+#define COUNTED_UNIFORM(name, proc, params, args) \
+    proc real##name = nullptr; \
+    void GLAPIENTRY counted##name params { \
+        frame.values[GLStats::UniformCalls]++; \
+        real##name args; \
+    }
+
+    COUNTED_UNIFORM(Uniform1i, PFNGLUNIFORM1IPROC, (GLint l, GLint v0), (l, v0))
+    COUNTED_UNIFORM(Uniform1f, PFNGLUNIFORM1FPROC, (GLint l, GLfloat v0), (l, v0))
+    COUNTED_UNIFORM(Uniform2f, PFNGLUNIFORM2FPROC, (GLint l, GLfloat v0, GLfloat v1), (l, v0, v1))
+    COUNTED_UNIFORM(Uniform3f, PFNGLUNIFORM3FPROC, (GLint l, GLfloat v0, GLfloat v1, GLfloat v2), (l, v0, v1, v2))
+    COUNTED_UNIFORM(Uniform4f, PFNGLUNIFORM4FPROC, (GLint l, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3), (l, v0, v1, v2, v3))
+    COUNTED_UNIFORM(Uniform1iv, PFNGLUNIFORM1IVPROC, (GLint l, GLsizei n, const GLint* v), (l, n, v))
+    COUNTED_UNIFORM(Uniform1fv, PFNGLUNIFORM1FVPROC, (GLint l, GLsizei n, const GLfloat* v), (l, n, v))
+    COUNTED_UNIFORM(Uniform2fv, PFNGLUNIFORM2FVPROC, (GLint l, GLsizei n, const GLfloat* v), (l, n, v))
+    COUNTED_UNIFORM(Uniform3fv, PFNGLUNIFORM3FVPROC, (GLint l, GLsizei n, const GLfloat* v), (l, n, v))
+    COUNTED_UNIFORM(Uniform4fv, PFNGLUNIFORM4FVPROC, (GLint l, GLsizei n, const GLfloat* v), (l, n, v))
+    COUNTED_UNIFORM(UniformMatrix3fv, PFNGLUNIFORMMATRIX3FVPROC, (GLint l, GLsizei n, GLboolean t, const GLfloat* v), (l, n, t, v))
+    COUNTED_UNIFORM(UniformMatrix4fv, PFNGLUNIFORMMATRIX4FVPROC, (GLint l, GLsizei n, GLboolean t, const GLfloat* v), (l, n, t, v))
+
+#undef COUNTED_UNIFORM
+
+    PFNGLBUFFERDATAPROC realBufferData = nullptr;
+    void GLAPIENTRY countedBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+        // Orphaning (data == nullptr) only reallocates, nothing is copied
+        if (data) {
+            frame.values[GLStats::UploadBytes] += static_cast<unsigned long long>(size);
+        }
+        realBufferData(target, size, data, usage);
+    }
+
+    PFNGLBUFFERSUBDATAPROC realBufferSubData = nullptr;
+    void GLAPIENTRY countedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+        frame.values[GLStats::UploadBytes] += static_cast<unsigned long long>(size);
+        realBufferSubData(target, offset, size, data);
+    }
+
+    PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced = nullptr;
+    void GLAPIENTRY countedDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances) {
+        GLStats::countDraw(mode, count, instances);
+        realDrawElementsInstanced(mode, count, type, indices, instances);
+    }
+
+    PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced = nullptr;
+    void GLAPIENTRY countedDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+        GLStats::countDraw(mode, count, instances);
+        realDrawArraysInstanced(mode, first, count, instances);
+    }
+
+    template <typename Proc>
+    void hook(Proc& entryPoint, Proc& real, Proc counted) {
+        if (entryPoint && entryPoint != counted) {
+            real = entryPoint;
+            entryPoint = counted;
+        }
+    }
+#endif
+}
+
+void GLStats::install() {
+#ifndef KOSTUR_NO_GL_STATS
+    if (installed) {
+        return;
+    }
+    hook(__glewUseProgram, realUseProgram, countedUseProgram);
+    hook(__glewGetUniformLocation, realGetUniformLocation, countedGetUniformLocation);
+    hook(__glewUniform1i, realUniform1i, countedUniform1i);
+    hook(__glewUniform1f, realUniform1f, countedUniform1f);
+    hook(__glewUniform2f, realUniform2f, countedUniform2f);
+    hook(__glewUniform3f, realUniform3f, countedUniform3f);
+    hook(__glewUniform4f, realUniform4f, countedUniform4f);
+    hook(__glewUniform1iv, realUniform1iv, countedUniform1iv);
+    hook(__glewUniform1fv, realUniform1fv, countedUniform1fv);
+    hook(__glewUniform2fv, realUniform2fv, countedUniform2fv);
+    hook(__glewUniform3fv, realUniform3fv, countedUniform3fv);
+    hook(__glewUniform4fv, realUniform4fv, countedUniform4fv);
+    hook(__glewUniformMatrix3fv, realUniformMatrix3fv, countedUniformMatrix3fv);
+    hook(__glewUniformMatrix4fv, realUniformMatrix4fv, countedUniformMatrix4fv);
+    hook(__glewBufferData, realBufferData, countedBufferData);
+    hook(__glewBufferSubData, realBufferSubData, countedBufferSubData);
+    hook(__glewDrawElementsInstanced, realDrawElementsInstanced, countedDrawElementsInstanced);
+    hook(__glewDrawArraysInstanced, realDrawArraysInstanced, countedDrawArraysInstanced);
+    installed = true;
+#endif
+}
+
+bool GLStats::isInstalled() {
+    return installed;
+}
+
+#ifndef KOSTUR_NO_GL_STATS
+void GLStats::countDraw(GLenum mode, GLsizei count, GLsizei instances) {
+    frame.values[DrawCalls]++;
+    frame.values[Triangles] += trianglesFor(mode, count) * static_cast<unsigned long long>(instances);
+}
+
+void GLStats::countTextureBind() {
+    frame.values[TextureBinds]++;
+}
+#endif
+
+void GLStats::endFrame() {
+    last = frame;
+    for (int i = 0; i < CounterCount; i++) {
+        runTotals.values[i] += frame.values[i];
+        runMaxima.values[i] = std::max(runMaxima.values[i], frame.values[i]);
+    }
+    runFrameCount++;
+    frame = Counters();
+}
+
+void GLStats::resetRun() {
+    frame = Counters();
+    runTotals = Counters();
+    runMaxima = Counters();
+    runFrameCount = 0;
+}
+
+const GLStats::Counters& GLStats::lastFrame() {
+    return last;
+}
+
+long long GLStats::runFrames() {
+    return runFrameCount;
+}
+
+double GLStats::runMean(Counter counter) {
+    return runFrameCount == 0 ? 0.0 : static_cast<double>(runTotals.values[counter]) / runFrameCount;
+}
+
+unsigned long long GLStats::runMax(Counter counter) {
+    return runMaxima.values[counter];
+}
+
+const char* GLStats::counterName(Counter counter) {
+    switch (counter) {
+    case DrawCalls: return "draw_calls";
+    case Triangles: return "triangles";
+    case UniformCalls: return "uniform_calls";
+    case UniformLookups: return "uniform_lookups";
+    case UploadBytes: return "upload_bytes";
+    case TextureBinds: return "texture_binds";
+    case ProgramSwitches: return "program_switches";
+    default: return "?";
+    }
+}
+
+bool GLStats::writeJson(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cout << "GL statistika nije upisana: " << path << std::endl;
+        return false;
+    }
+
+    std::fprintf(file, "{\n  \"frames\": %lld,\n  \"per_frame\": {\n", runFrameCount);
+    for (int i = 0; i < CounterCount; i++) {
+        Counter counter = static_cast<Counter>(i);
+        std::fprintf(file, "    \"%s\": { \"mean\": %.2f, \"max\": %llu }%s\n",
+            counterName(counter), runMean(counter), runMax(counter), i + 1 < CounterCount ? "," : "");
+    }
+    std::fprintf(file, "  }\n}\n");
+    std::fclose(file);
+    return true;
+}
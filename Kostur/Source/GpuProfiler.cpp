@@ -0,0 +1,157 @@
+#include "../Header/GpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    const int ZONE_COUNT = static_cast<int>(GpuZone::Count);
+
+    double percentile(std::vector<float> samples, double p) {
+        if (samples.empty()) {
+            return 0.0;
+        }
+        std::sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+}
+
+GpuProfiler::GpuProfiler()
+    : frameIndex(0), queryActive(false), droppedFrames(0), historyCursor(0), historyCount(0), recording(false),
+    segmentSink(nullptr)
+{
+    for (FrameQueries& frame : frames) {
+        glGenQueries(MAX_SEGMENTS_PER_FRAME * 2, frame.ids);
+        frame.count = 0;
+        frame.pending = false;
+    }
+    for (int zone = 0; zone < ZONE_COUNT; zone++) {
+        std::fill(history[zone], history[zone] + HISTORY_FRAMES, 0.0f);
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    for (FrameQueries& frame : frames) {
+        glDeleteQueries(MAX_SEGMENTS_PER_FRAME * 2, frame.ids);
+    }
+}
+
+const char* GpuProfiler::zoneName(GpuZone zone) {
+    switch (zone) {
+    case GpuZone::Room: return "room";
+    case GpuZone::Light: return "light";
+    case GpuZone::Weapons: return "weapons";
+    case GpuZone::Targets: return "targets";
+    case GpuZone::HudSprites: return "hud_sprites";
+    case GpuZone::Text: return "text";
+    default: return "?";
+    }
+}
+
+void GpuProfiler::readBack(FrameQueries& frame) {
+    // Queries finish in submission order, so the last one being ready means all are
+    GLint available = 0;
+    glGetQueryObjectiv(frame.ids[frame.count * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        droppedFrames++;
+        return;
+    }
+
+    double totals[ZONE_COUNT] = {};
+    for (int i = 0; i < frame.count; i++) {
+        GLuint64 startNs = 0, endNs = 0;
+        glGetQueryObjectui64v(frame.ids[i * 2], GL_QUERY_RESULT, &startNs);
+        glGetQueryObjectui64v(frame.ids[i * 2 + 1], GL_QUERY_RESULT, &endNs);
+        totals[static_cast<int>(frame.zones[i])] += (endNs - startNs) / 1.0e6;
+        if (segmentSink) {
+            segmentSink->push_back({ frame.zones[i], startNs, endNs });
+        }
+    }
+
+    for (int zone = 0; zone < ZONE_COUNT; zone++) {
+        history[zone][historyCursor] = static_cast<float>(totals[zone]);
+        if (recording) {
+            runSamples[zone].push_back(static_cast<float>(totals[zone]));
+        }
+    }
+    historyCursor = (historyCursor + 1) % HISTORY_FRAMES;
+    historyCount = std::min(historyCount + 1, HISTORY_FRAMES);
+}
+
+void GpuProfiler::beginFrame() {
+    frameIndex = (frameIndex + 1) % FRAMES_IN_FLIGHT;
+    FrameQueries& frame = frames[frameIndex];
+    if (frame.pending) {
+        readBack(frame);
+    }
+    frame.count = 0;
+    frame.pending = false;
+}
+
+void GpuProfiler::begin(GpuZone zone) {
+    end();
+    FrameQueries& frame = frames[frameIndex];
+    if (frame.count == MAX_SEGMENTS_PER_FRAME) {
+        return;
+    }
+    frame.zones[frame.count] = zone;
+    glQueryCounter(frame.ids[frame.count * 2], GL_TIMESTAMP);
+    queryActive = true;
+}
+
+void GpuProfiler::end() {
+    if (!queryActive) {
+        return;
+    }
+    FrameQueries& frame = frames[frameIndex];
+    glQueryCounter(frame.ids[frame.count * 2 + 1], GL_TIMESTAMP);
+    frame.count++;
+    queryActive = false;
+}
+
+void GpuProfiler::endFrame() {
+    end();
+    frames[frameIndex].pending = frames[frameIndex].count > 0;
+}
+
+double GpuProfiler::averageMs(GpuZone zone) const {
+    if (historyCount == 0) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (int i = 0; i < historyCount; i++) {
+        sum += history[static_cast<int>(zone)][i];
+    }
+    return sum / historyCount;
+}
+
+double GpuProfiler::maxMs(GpuZone zone) const {
+    const float* samples = history[static_cast<int>(zone)];
+    return historyCount == 0 ? 0.0 : *std::max_element(samples, samples + historyCount);
+}
+
+bool GpuProfiler::writeJson(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cout << "GPU profil nije upisan: " << path << std::endl;
+        return false;
+    }
+
+    std::fprintf(file, "{\n  \"frames\": %zu,\n  \"dropped_frames\": %d,\n  \"passes_ms\": {\n",
+        runSamples[0].size(), droppedFrames);
+    for (int zone = 0; zone < ZONE_COUNT; zone++) {
+        const std::vector<float>& samples = runSamples[zone];
+        double sum = 0.0;
+        for (float sample : samples) {
+            sum += sample;
+        }
+        std::fprintf(file, "    \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+            zoneName(static_cast<GpuZone>(zone)), samples.empty() ? 0.0 : sum / samples.size(),
+            percentile(samples, 0.50), percentile(samples, 0.99), percentile(samples, 1.0),
+            zone + 1 < ZONE_COUNT ? "," : "");
+    }
+    std::fprintf(file, "  }\n}\n");
+    std::fclose(file);
+    return true;
+}
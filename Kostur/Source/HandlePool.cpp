@@ -0,0 +1,55 @@
+#include "../Header/HandlePool.h"
+
+HandleTable::HandleTable(int capacity) : slots(capacity), freeHead(-1), count(0) {
+    denseToSlot.reserve(capacity);
+    for (int i = 0; i < capacity; i++) {
+        slots[i].generation = 1;
+        slots[i].link = -1;
+    }
+    clear();
+}
+
+PoolHandle HandleTable::allocate() {
+    if (freeHead < 0) {
+        return PoolHandle();
+    }
+    int slot = freeHead;
+    freeHead = slots[slot].link;
+    slots[slot].link = count++;
+    denseToSlot.push_back(static_cast<uint32_t>(slot));
+    return PoolHandle(static_cast<uint32_t>(slot), slots[slot].generation);
+}
+
+void HandleTable::releaseAt(int denseIndex) {
+    uint32_t slot = denseToSlot[denseIndex];
+    uint32_t lastSlot = denseToSlot[count - 1];
+    denseToSlot[denseIndex] = lastSlot;
+    slots[lastSlot].link = denseIndex;
+    denseToSlot.pop_back();
+    count--;
+
+    // Skip 0 on wrap-around, it means null
+    if (++slots[slot].generation == 0) {
+        slots[slot].generation = 1;
+    }
+    slots[slot].link = freeHead;
+    freeHead = static_cast<int>(slot);
+}
+
+void HandleTable::clear() {
+    // Every live slot is retired, so handles from before the clear stay invalid
+    for (uint32_t slot : denseToSlot) {
+        if (++slots[slot].generation == 0) {
+            slots[slot].generation = 1;
+        }
+    }
+    denseToSlot.clear();
+    count = 0;
+
+    // Lowest slot first
+    freeHead = -1;
+    for (int i = static_cast<int>(slots.size()) - 1; i >= 0; i--) {
+        slots[i].link = freeHead;
+        freeHead = i;
+    }
+}
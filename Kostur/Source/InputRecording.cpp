@@ -0,0 +1,189 @@
+#include "../Header/InputRecording.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const char MAGIC[4] = { 'K', 'R', 'E', 'C' };
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+    // Fixed-size fields are stored little-endian, as on every platform the game builds for
+    template <typename T>
+    void writeRaw(FILE* file, const T& value) {
+        std::fwrite(&value, sizeof(value), 1, file);
+    }
+
+    bool hasTime(InputEvent::Type type) {
+        return type != InputEvent::Tick;
+    }
+
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+}
+
+bool InputRecorder::start(const std::string& path, uint64_t seed, uint64_t startNs) {
+    finish();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "Snimak nije moguce otvoriti: " << path << std::endl;
+        return false;
+    }
+    std::fwrite(MAGIC, sizeof(MAGIC), 1, file);
+    writeRaw(file, VERSION);
+    writeRaw(file, seed);
+    writeRaw(file, startNs);
+    lastTimeNs = startNs;
+    eventCount = 0;
+    return true;
+}
+
+void InputRecorder::writeVarint(uint64_t value) {
+    unsigned char bytes[10];
+    int count = 0;
+    do {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        bytes[count++] = value != 0 ? (byte | 0x80) : byte;
+    } while (value != 0);
+    std::fwrite(bytes, 1, count, file);
+}
+
+void InputRecorder::record(const InputEvent& event) {
+    if (!file) return;
+
+    std::fputc(event.type, file);
+    if (hasTime(event.type)) {
+        writeVarint(zigzag(static_cast<int64_t>(event.timeNs - lastTimeNs)));
+        lastTimeNs = event.timeNs;
+    }
+    switch (event.type) {
+    case InputEvent::Motion:
+    case InputEvent::ButtonDown:
+        writeRaw(file, event.x);
+        writeRaw(file, event.y);
+        break;
+    case InputEvent::Key:
+        writeVarint(static_cast<uint64_t>(event.key));
+        break;
+    case InputEvent::Tick:
+        writeRaw(file, event.deltaTime);
+        break;
+    default:
+        break;
+    }
+    eventCount++;
+}
+
+void InputRecorder::finish() {
+    if (!file) return;
+    std::fclose(file);
+    file = nullptr;
+}
+
+bool InputPlayer::open(const std::string& path) {
+    data.clear();
+    hasUpcoming = false;
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cout << "Snimak nije pronadjen: " << path << std::endl;
+        return false;
+    }
+    unsigned char buffer[65536];
+    size_t bytes;
+    while ((bytes = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + bytes);
+    }
+    std::fclose(file);
+
+    uint32_t version = 0;
+    if (data.size() >= HEADER_SIZE) {
+        std::memcpy(&version, data.data() + sizeof(MAGIC), sizeof(version));
+    }
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+        std::cout << "Neispravan snimak: " << path << std::endl;
+        data.clear();
+        return false;
+    }
+    std::memcpy(&seed, data.data() + sizeof(MAGIC) + sizeof(uint32_t), sizeof(seed));
+    std::memcpy(&startNs, data.data() + sizeof(MAGIC) + sizeof(uint32_t) + sizeof(uint64_t), sizeof(startNs));
+
+    cursor = HEADER_SIZE;
+    lastTimeNs = startNs;
+    hasUpcoming = decode(upcoming);
+    return true;
+}
+
+bool InputPlayer::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < data.size(); shift += 7) {
+        unsigned char byte = data[cursor++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InputPlayer::readFloat(float& value) {
+    if (cursor + sizeof(value) > data.size()) {
+        return false;
+    }
+    std::memcpy(&value, data.data() + cursor, sizeof(value));
+    cursor += sizeof(value);
+    return true;
+}
+
+bool InputPlayer::decode(InputEvent& event) {
+    if (cursor >= data.size() || data[cursor] >= InputEvent::TypeCount) {
+        return false;
+    }
+    event = InputEvent();
+    event.type = static_cast<InputEvent::Type>(data[cursor++]);
+
+    if (hasTime(event.type)) {
+        uint64_t delta;
+        if (!readVarint(delta)) return false;
+        lastTimeNs += static_cast<uint64_t>(unzigzag(delta));
+        event.timeNs = lastTimeNs;
+    }
+    switch (event.type) {
+    case InputEvent::Motion:
+    case InputEvent::ButtonDown:
+        return readFloat(event.x) && readFloat(event.y);
+    case InputEvent::Key: {
+        uint64_t key;
+        if (!readVarint(key)) return false;
+        event.key = static_cast<int>(key);
+        return true;
+    }
+    case InputEvent::Tick:
+        return readFloat(event.deltaTime);
+    default:
+        return true;
+    }
+}
+
+bool InputPlayer::next(InputEvent& event) {
+    if (!hasUpcoming) {
+        return false;
+    }
+    event = upcoming;
+    hasUpcoming = decode(upcoming);
+    return true;
+}
+
+bool InputPlayer::readFrame(std::vector<InputEvent>& events) {
+    events.clear();
+    InputEvent event;
+    while ((events.empty() || upcoming.type != InputEvent::Frame) && next(event)) {
+        events.push_back(event);
+    }
+    return !events.empty();
+}
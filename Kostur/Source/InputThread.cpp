@@ -0,0 +1,273 @@
+#include "../Header/InputThread.h"
+#include "../Header/Profiler.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <future>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+InputThread::InputThread()
+    : running(false), droppedSamples(0), backend("none")
+{
+#ifdef _WIN32
+    messageWindow = nullptr;
+#else
+    wakePipe[0] = wakePipe[1] = -1;
+    deviceCount = 0;
+#endif
+}
+
+InputThread::~InputThread() {
+    stop();
+}
+
+void InputThread::push(const MouseSample& sample) {
+    if (!queue.push(sample)) {
+        droppedSamples.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#ifdef _WIN32
+
+namespace {
+    const wchar_t* WINDOW_CLASS = L"KosturRawInput";
+    const UINT STOP_MESSAGE = WM_APP + 1;
+}
+
+bool InputThread::start() {
+    if (isRunning()) {
+        return true;
+    }
+
+    // The window has to be created on the thread that pumps its messages
+    std::promise<bool> ready;
+    std::future<bool> readyResult = ready.get_future();
+    running.store(true, std::memory_order_release);
+    thread = std::thread([this, &ready]() {
+        HINSTANCE instance = GetModuleHandleW(nullptr);
+        WNDCLASSEXW windowClass = {};
+        windowClass.cbSize = sizeof(windowClass);
+        windowClass.lpfnWndProc = DefWindowProcW;
+        windowClass.hInstance = instance;
+        windowClass.lpszClassName = WINDOW_CLASS;
+        RegisterClassExW(&windowClass);  // fails harmlessly when already registered
+
+        HWND window = CreateWindowExW(0, WINDOW_CLASS, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, instance, nullptr);
+        // RIDEV_INPUTSINK: the message-only window never has focus
+        RAWINPUTDEVICE device = { 0x01, 0x02, RIDEV_INPUTSINK, window };
+        if (!window || !RegisterRawInputDevices(&device, 1, sizeof(device))) {
+            if (window) {
+                DestroyWindow(window);
+            }
+            ready.set_value(false);
+            return;
+        }
+        messageWindow.store(window);
+        ready.set_value(true);
+        run();
+
+        RAWINPUTDEVICE removeDevice = { 0x01, 0x02, RIDEV_REMOVE, nullptr };
+        RegisterRawInputDevices(&removeDevice, 1, sizeof(removeDevice));
+        DestroyWindow(window);
+    });
+
+    if (!readyResult.get()) {
+        thread.join();
+        running.store(false, std::memory_order_release);
+        return false;
+    }
+    backend = "Raw Input";
+    return true;
+}
+
+void InputThread::run() {
+    MSG message;
+    while (GetMessageW(&message, nullptr, 0, 0) > 0 && message.message != STOP_MESSAGE) {
+        if (message.message == WM_INPUT) {
+            uint64_t now = Profiler::nowNs();
+            RAWINPUT raw;
+            UINT size = sizeof(raw);
+            if (GetRawInputData(reinterpret_cast<HRAWINPUT>(message.lParam), RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) != static_cast<UINT>(-1)
+                && raw.header.dwType == RIM_TYPEMOUSE) {
+                const RAWMOUSE& mouse = raw.data.mouse;
+                if (!(mouse.usFlags & MOUSE_MOVE_ABSOLUTE) && (mouse.lLastX != 0 || mouse.lLastY != 0)) {
+                    push({ now, static_cast<float>(mouse.lLastX), -static_cast<float>(mouse.lLastY), MouseSample::Motion });
+                }
+                if (mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_DOWN) {
+                    push({ now, 0.0f, 0.0f, MouseSample::ButtonDown });
+                }
+                if (mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_UP) {
+                    push({ now, 0.0f, 0.0f, MouseSample::ButtonUp });
+                }
+            }
+        }
+        // WM_INPUT still has to reach DefWindowProc so the system can free the input
+        DispatchMessageW(&message);
+    }
+}
+
+void InputThread::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    PostMessageW(static_cast<HWND>(messageWindow.load()), STOP_MESSAGE, 0, 0);
+    thread.join();
+    messageWindow = nullptr;
+    running.store(false, std::memory_order_release);
+}
+
+#else
+
+namespace {
+    bool hasBit(const unsigned long* bits, int bit) {
+        const int bitsPerLong = 8 * sizeof(unsigned long);
+        return (bits[bit / bitsPerLong] >> (bit % bitsPerLong)) & 1ul;
+    }
+
+    uint64_t eventTimeNs(const input_event& event) {
+        return static_cast<uint64_t>(event.input_event_sec) * 1000000000ull + static_cast<uint64_t>(event.input_event_usec) * 1000ull;
+    }
+}
+
+bool InputThread::start() {
+    if (isRunning()) {
+        return true;
+    }
+
+    deviceCount = 0;
+    for (int i = 0; i < 32 && deviceCount < MAX_DEVICES; i++) {
+        char path[32];
+        std::snprintf(path, sizeof(path), "/dev/input/event%d", i);
+        int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        // A mouse reports relative X/Y and has a left button
+        unsigned long relativeBits[REL_MAX / (8 * sizeof(unsigned long)) + 1] = {};
+        unsigned long keyBits[KEY_MAX / (8 * sizeof(unsigned long)) + 1] = {};
+        bool isMouse = ioctl(fd, EVIOCGBIT(EV_REL, sizeof(relativeBits)), relativeBits) >= 0
+            && ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) >= 0
+            && hasBit(relativeBits, REL_X) && hasBit(relativeBits, REL_Y) && hasBit(keyBits, BTN_LEFT);
+        if (!isMouse) {
+            close(fd);
+            continue;
+        }
+
+        // steady_clock is CLOCK_MONOTONIC, so event times can be used as they are
+        int clock = CLOCK_MONOTONIC;
+        deviceMonotonic[deviceCount] = ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+        deviceFds[deviceCount++] = fd;
+    }
+
+    if (deviceCount == 0 || pipe2(wakePipe, O_CLOEXEC) != 0) {
+        for (int i = 0; i < deviceCount; i++) {
+            close(deviceFds[i]);
+        }
+        deviceCount = 0;
+        return false;
+    }
+
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&InputThread::run, this);
+    backend = "evdev";
+    return true;
+}
+
+void InputThread::run() {
+    pollfd fds[MAX_DEVICES + 1];
+    fds[0] = { wakePipe[0], POLLIN, 0 };
+    for (int i = 0; i < deviceCount; i++) {
+        fds[i + 1] = { deviceFds[i], POLLIN, 0 };
+    }
+    float pendingDx[MAX_DEVICES] = {};
+    float pendingDy[MAX_DEVICES] = {};
+    auto flushMotion = [&](int device, uint64_t timeNs) {
+        if (pendingDx[device] != 0.0f || pendingDy[device] != 0.0f) {
+            push({ timeNs, pendingDx[device], pendingDy[device], MouseSample::Motion });
+            pendingDx[device] = 0.0f;
+            pendingDy[device] = 0.0f;
+        }
+    };
+
+    input_event events[64];
+    while (true) {
+        if (poll(fds, deviceCount + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[0].revents) {
+            break;
+        }
+
+        for (int device = 0; device < deviceCount; device++) {
+            pollfd& fd = fds[device + 1];
+            if (fd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                fd.fd = -1;  // unplugged; poll skips negative descriptors
+                continue;
+            }
+            if (!(fd.revents & POLLIN)) {
+                continue;
+            }
+
+            ssize_t bytes;
+            while ((bytes = read(fd.fd, events, sizeof(events))) > 0) {
+                int count = static_cast<int>(bytes / sizeof(input_event));
+                for (int i = 0; i < count; i++) {
+                    const input_event& event = events[i];
+                    uint64_t timeNs = deviceMonotonic[device] ? eventTimeNs(event) : Profiler::nowNs();
+                    if (event.type == EV_REL && event.code == REL_X) {
+                        pendingDx[device] += static_cast<float>(event.value);
+                    }
+                    else if (event.type == EV_REL && event.code == REL_Y) {
+                        pendingDy[device] -= static_cast<float>(event.value);  // evdev Y grows downwards
+                    }
+                    else if (event.type == EV_KEY && event.code == BTN_LEFT && event.value != 2) {
+                        // Motion from the same report goes first, so the click lands where the cursor ended up
+                        flushMotion(device, timeNs);
+                        push({ timeNs, 0.0f, 0.0f, event.value ? MouseSample::ButtonDown : MouseSample::ButtonUp });
+                    }
+                    else if (event.type == EV_SYN && event.code == SYN_REPORT) {
+                        // One hardware report, one sample
+                        flushMotion(device, timeNs);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void InputThread::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    char wake = 1;
+    if (write(wakePipe[1], &wake, 1) != 1) {
+        std::perror("InputThread wake");
+    }
+    thread.join();
+    running.store(false, std::memory_order_release);
+
+    for (int i = 0; i < deviceCount; i++) {
+        close(deviceFds[i]);
+    }
+    deviceCount = 0;
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    wakePipe[0] = wakePipe[1] = -1;
+}
+
+#endif
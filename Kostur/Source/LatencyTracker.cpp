@@ -0,0 +1,117 @@
+#include "../Header/LatencyTracker.h"
+#include "../Header/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyTracker::LatencyTracker()
+    : fencedHead(0), fencedCount(0), droppedClicks(0)
+{
+    resolved.count = 0;
+    submitted.count = 0;
+    for (int stage = 0; stage < StageCount; stage++) {
+        std::fill(history[stage], history[stage] + HISTORY, 0.0f);
+        historyCursor[stage] = 0;
+        historyCount[stage] = 0;
+    }
+}
+
+LatencyTracker::~LatencyTracker() {
+    for (int i = 0; i < fencedCount; i++) {
+        glDeleteSync(fenced[(fencedHead + i) % MAX_FENCED_FRAMES].fence);
+    }
+}
+
+const char* LatencyTracker::stageName(Stage stage) {
+    switch (stage) {
+    case Hit: return "hit";
+    case Submit: return "submit";
+    case Swap: return "swap";
+    case Present: return "present";
+    default: return "?";
+    }
+}
+
+void LatencyTracker::addSample(Stage stage, uint64_t inputNs, uint64_t nowNs) {
+    history[stage][historyCursor[stage]] = static_cast<float>((nowNs - inputNs) / 1.0e6);
+    historyCursor[stage] = (historyCursor[stage] + 1) % HISTORY;
+    historyCount[stage] = std::min(historyCount[stage] + 1, HISTORY);
+}
+
+void LatencyTracker::clickResolved(uint64_t inputNs) {
+    addSample(Hit, inputNs, Profiler::nowNs());
+    if (resolved.count == MAX_CLICKS_PER_FRAME) {
+        droppedClicks++;
+        return;
+    }
+    resolved.inputNs[resolved.count++] = inputNs;
+}
+
+void LatencyTracker::frameSubmitted() {
+    uint64_t now = Profiler::nowNs();
+    for (int i = 0; i < resolved.count; i++) {
+        addSample(Submit, resolved.inputNs[i], now);
+    }
+    submitted = resolved;
+    resolved.count = 0;
+}
+
+void LatencyTracker::frameSwapped() {
+    uint64_t now = Profiler::nowNs();
+    for (int i = 0; i < submitted.count; i++) {
+        addSample(Swap, submitted.inputNs[i], now);
+    }
+    poll();
+
+    // Frames without clicks need no fence
+    if (submitted.count > 0) {
+        if (fencedCount == MAX_FENCED_FRAMES) {
+            droppedClicks += submitted.count;
+        }
+        else {
+            FencedFrame& frame = fenced[(fencedHead + fencedCount) % MAX_FENCED_FRAMES];
+            frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            frame.clicks = submitted;
+            fencedCount++;
+        }
+    }
+    submitted.count = 0;
+}
+
+void LatencyTracker::poll() {
+    // Fences signal in order, so stop at the first one that is still pending
+    while (fencedCount > 0) {
+        FencedFrame& frame = fenced[fencedHead];
+        GLenum status = glClientWaitSync(frame.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return;
+        }
+        uint64_t now = Profiler::nowNs();
+        for (int i = 0; i < frame.clicks.count; i++) {
+            addSample(Present, frame.clicks.inputNs[i], now);
+        }
+        glDeleteSync(frame.fence);
+        fencedHead = (fencedHead + 1) % MAX_FENCED_FRAMES;
+        fencedCount--;
+    }
+}
+
+LatencyTracker::Distribution LatencyTracker::distribution(Stage stage) const {
+    Distribution result = { historyCount[stage], 0.0, 0.0, 0.0, 0.0 };
+    if (historyCount[stage] == 0) {
+        return result;
+    }
+
+    float samples[HISTORY];
+    int count = historyCount[stage];
+    std::copy(history[stage], history[stage] + count, samples);
+    std::sort(samples, samples + count);
+    auto percentile = [&](double p) {
+        int rank = static_cast<int>(std::ceil(p * count));
+        return static_cast<double>(samples[std::max(0, std::min(count, rank) - 1)]);
+    };
+    result.p50Ms = percentile(0.50);
+    result.p90Ms = percentile(0.90);
+    result.p99Ms = percentile(0.99);
+    result.maxMs = samples[count - 1];
+    return result;
+}
@@ -3,13 +3,57 @@
 
 #include "../Header/Util.h"
 #include "../Header/AimTrainer.h"
+#include "../Header/RenderState.h"
+#include "../Header/FrameScheduler.h"
+#include "../Header/Profiler.h"
+#include "../Header/GLStats.h"
+#include "../Header/TraceCapture.h"
+#include "../Header/InputThread.h"
+#include "../Header/InputRecording.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+struct LaunchOptions {
+    FrameMode frameMode = FrameMode::VSync;
+    double targetFps = 0.0;      // 0 = monitor refresh rate
+    double tickRate = 120.0;     // simulation rate
+    std::string gpuProfilePath;  // per-pass GPU times for the whole run, written on exit
+    std::string glStatsPath;     // GL call counts per frame for the whole run, written on exit
+    std::string tracePath = "trace.json";
+    int traceFrames = 300;
+    bool traceOnStart = false;   // --trace starts a capture right away, T starts one at any time
+    bool inputThread = true;     // --no-input-thread keeps mouse input on the GLFW callbacks
+    uint64_t seed = 0;           // target placement, 0 = from the current time
+    std::string recordPath;      // input recording of the session
+    std::string replayPath;      // plays a recording instead of live input
+    bool replayFast = false;     // replay without waiting for the recorded frame times
+};
 
 AimTrainer* game = nullptr;
+LaunchOptions launchOptions;
+TraceCapture traceCapture;
+InputThread inputThread;
+InputRecorder inputRecorder;
+InputPlayer inputPlayer;
+uint64_t replayWallStartNs = 0;
 bool firstMouse = true;
 double lastMouseX = 0.0;
 double lastMouseY = 0.0;
 
+// All game input goes through here, live or replayed, so a recording sees exactly what the game saw
+static void dispatchInput(const InputEvent& event) {
+    inputRecorder.record(event);
+    game->applyInput(event);
+}
+
+// The callbacks only drive the game when neither the input thread nor a replay is running
 void mouseMovementCallback(GLFWwindow* window, double xpos, double ypos) {
+    if (inputThread.isRunning() || inputPlayer.isOpen()) return;
+
     if (firstMouse) {
         lastMouseX = xpos;
         lastMouseY = ypos;
@@ -21,20 +65,54 @@ void mouseMovementCallback(GLFWwindow* window, double xpos, double ypos) {
     
     lastMouseX = xpos;
     lastMouseY = ypos;
+    traceCapture.recordInput("mouse_move", xoffset, yoffset);
     
     if (game) {
-        game->processMouseMovement(static_cast<float>(xoffset), static_cast<float>(yoffset));
+        dispatchInput(InputEvent::motion(Profiler::nowNs(), static_cast<float>(xoffset), static_cast<float>(yoffset)));
     }
 }
 
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    if (inputThread.isRunning() || inputPlayer.isOpen()) return;
+
+    uint64_t inputTimeNs = Profiler::nowNs();
+    if (button == GLFW_MOUSE_BUTTON_LEFT) {
+        traceCapture.recordInput(action == GLFW_PRESS ? "mouse_press" : "mouse_release", lastMouseX, lastMouseY);
+    }
     if (button == GLFW_MOUSE_BUTTON_LEFT && game) {
         if (action == GLFW_PRESS) {
             double mouseX, mouseY;
             glfwGetCursorPos(window, &mouseX, &mouseY);
-            game->handleMousePress(mouseX, mouseY);
+            dispatchInput(InputEvent::buttonDown(inputTimeNs, static_cast<float>(mouseX), static_cast<float>(mouseY)));
         } else if (action == GLFW_RELEASE) {
-            game->handleMouseRelease();
+            dispatchInput(InputEvent::buttonUp(inputTimeNs));
+        }
+    }
+}
+
+// Applies every queued mouse report in order, so a click lands on the aim it
+// had at that moment rather than on the aim at the end of the frame
+static void drainInputSamples(GLFWwindow* window) {
+    // RIDEV_INPUTSINK / evdev also see the mouse while another window has focus
+    bool focused = glfwGetWindowAttrib(window, GLFW_FOCUSED) == GLFW_TRUE;
+    MouseSample sample;
+    while (inputThread.pop(sample)) {
+        if (!focused || !game) continue;
+
+        if (sample.type == MouseSample::Motion) {
+            traceCapture.recordInput("mouse_move", sample.dx, sample.dy, sample.timeNs);
+            dispatchInput(InputEvent::motion(sample.timeNs, sample.dx, sample.dy));
+        }
+        else if (sample.type == MouseSample::ButtonDown) {
+            // Game-over buttons are hit-tested against GLFW's virtual cursor
+            double mouseX, mouseY;
+            glfwGetCursorPos(window, &mouseX, &mouseY);
+            traceCapture.recordInput("mouse_press", mouseX, mouseY, sample.timeNs);
+            dispatchInput(InputEvent::buttonDown(sample.timeNs, static_cast<float>(mouseX), static_cast<float>(mouseY)));
+        }
+        else {
+            traceCapture.recordInput("mouse_release", 0.0, 0.0, sample.timeNs);
+            dispatchInput(InputEvent::buttonUp(sample.timeNs));
         }
     }
 }
@@ -43,32 +121,75 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, GLFW_TRUE);
     }
-    
-    if (key == GLFW_KEY_R && action == GLFW_PRESS && game) {
-        if (game->isGameOver()) {
-            game->restart();
-        }
+    else if (key == GLFW_KEY_T && action == GLFW_PRESS && game) {
+        traceCapture.start(launchOptions.tracePath, launchOptions.traceFrames, game->getGpuProfiler());
     }
-    
-    if (key == GLFW_KEY_1 && action == GLFW_PRESS && game) {
-        game->setFireMode(FireMode::AK47);
+    else if (action == GLFW_PRESS && game && !inputPlayer.isOpen()) {
+        dispatchInput(InputEvent::keyPress(Profiler::nowNs(), key));
     }
-    
-    if (key == GLFW_KEY_2 && action == GLFW_PRESS && game) {
-        game->setFireMode(FireMode::USP);
+}
+
+// Feeds the game one recorded frame: its clock reading, then its input and ticks up to
+// the next Frame event. In real time it first waits until the frame is due. False once
+// the recording is over
+static bool replayFrame(bool realTime) {
+    static std::vector<InputEvent> events;
+    if (!inputPlayer.readFrame(events)) return false;
+
+    const InputEvent& first = events.front();
+    if (first.type == InputEvent::Frame && realTime && first.timeNs > inputPlayer.getStartNs()) {
+        uint64_t dueNs = replayWallStartNs + (first.timeNs - inputPlayer.getStartNs());
+        uint64_t nowNs = Profiler::nowNs();
+        if (dueNs > nowNs) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(dueNs - nowNs));
+        }
     }
-    
-    if (key == GLFW_KEY_D && action == GLFW_PRESS && game) {
-        game->toggleDepthTest();
+    for (const InputEvent& event : events) {
+        dispatchInput(event);
     }
-    
-    if (key == GLFW_KEY_F && action == GLFW_PRESS && game) {
-        game->toggleFaceCulling();
+    return true;
+}
+
+static bool parseOptions(int argc, char** argv, LaunchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--uncapped") == 0) options.frameMode = FrameMode::Uncapped;
+        else if (std::strcmp(argv[i], "--vsync") == 0) options.frameMode = FrameMode::VSync;
+        else if (std::strcmp(argv[i], "--fps") == 0 && hasValue) {
+            options.frameMode = FrameMode::Capped;
+            options.targetFps = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--tick") == 0 && hasValue) options.tickRate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--gpu-profile") == 0 && hasValue) options.gpuProfilePath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-stats") == 0 && hasValue) options.glStatsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            options.tracePath = argv[++i];
+            options.traceOnStart = true;
+        }
+        else if (std::strcmp(argv[i], "--trace-frames") == 0 && hasValue) options.traceFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--no-input-thread") == 0) options.inputThread = false;
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--record") == 0 && hasValue) options.recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) options.replayPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay-fast") == 0) {
+            options.replayFast = true;
+            options.frameMode = FrameMode::Uncapped;
+        }
+        else {
+            std::cout << "Upotreba: Kostur [--uncapped | --vsync | --fps N] [--tick HZ] [--gpu-profile FILE] [--gl-stats FILE]"
+                " [--trace FILE] [--trace-frames N] [--no-input-thread] [--seed N]"
+                " [--record FILE] [--replay FILE] [--replay-fast]" << std::endl;
+            return false;
+        }
     }
+    if (options.replayFast && options.replayPath.empty()) return false;
+    return options.targetFps >= 0.0 && options.tickRate > 0.0 && options.traceFrames > 0;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    if (!parseOptions(argc, argv, launchOptions)) return -1;
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -84,19 +205,23 @@ int main()
     if (window == NULL) return endProgram("Prozor nije uspeo da se kreira.");
     glfwMakeContextCurrent(window);
 
-    glfwSwapInterval(1);
+    // Without --fps the cap follows the monitor, so high-refresh displays are not held at 75
+    double targetFps = launchOptions.targetFps > 0.0 ? launchOptions.targetFps : (mode->refreshRate > 0 ? mode->refreshRate : 60.0);
+    FrameScheduler scheduler(launchOptions.frameMode, targetFps, launchOptions.tickRate);
+    scheduler.applySwapInterval();
 
     if (glewInit() != GLEW_OK) return endProgram("GLEW nije uspeo da se inicijalizuje.");
+    GLStats::install();
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderState::setEnabled(GL_BLEND, true);
+    RenderState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    RenderState::setEnabled(GL_DEPTH_TEST, true);
+    RenderState::depthFunc(GL_LESS);
     
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    RenderState::setEnabled(GL_CULL_FACE, true);
+    RenderState::cullFace(GL_BACK);
+    RenderState::frontFace(GL_CCW);
 
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     
@@ -108,35 +233,102 @@ int main()
     glfwSetCursorPosCallback(window, mouseMovementCallback);
     glfwSetKeyCallback(window, keyCallback);
 
+    // GLFW raw motion would take over the process-wide raw mouse registration, so it is only the fallback
+    if (launchOptions.inputThread && launchOptions.replayPath.empty() && inputThread.start()) {
+        std::cout << "Mis se cita u zasebnoj niti (" << inputThread.getBackend() << ")" << std::endl;
+    }
+    else if (glfwRawMouseMotionSupported()) {
+        glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+    }
+
     glClearColor(0.15f, 0.15f, 0.2f, 1.0f);
 
-    game = new AimTrainer(WINDOW_WIDTH, WINDOW_HEIGHT);
+    uint64_t seed = launchOptions.seed != 0 ? launchOptions.seed : static_cast<uint64_t>(time(nullptr));
+    uint64_t startNs = Profiler::nowNs();
+    if (!launchOptions.replayPath.empty()) {
+        if (!inputPlayer.open(launchOptions.replayPath)) return endProgram("Snimak nije ucitan.");
+        seed = inputPlayer.getSeed();
+        startNs = inputPlayer.getStartNs();
+        replayWallStartNs = Profiler::nowNs();
+        std::cout << "Reprodukcija snimka " << launchOptions.replayPath << (launchOptions.replayFast ? " (najbrze moguce)" : "") << std::endl;
+    }
+    std::cout << "Seed: " << seed << std::endl;
+    game = new AimTrainer(WINDOW_WIDTH, WINDOW_HEIGHT, seed, startNs);
+    game->setLatencyTracking(!inputPlayer.isOpen());
+    if (!launchOptions.recordPath.empty()) {
+        inputRecorder.start(launchOptions.recordPath, seed, startNs);
+    }
+    game->getGpuProfiler()->setRecording(!launchOptions.gpuProfilePath.empty());
+    GLStats::resetRun();
+    if (launchOptions.traceOnStart) {
+        traceCapture.start(launchOptions.tracePath, launchOptions.traceFrames, game->getGpuProfiler());
+    }
     
-    double lastTime = glfwGetTime();
-    const double targetFPS = 75.0;
-    const double targetFrameTime = 1.0 / targetFPS;
-
     while (!glfwWindowShouldClose(window))
     {
-        double currentTime = glfwGetTime();
-        double deltaTime = currentTime - lastTime;
-        
-        if (deltaTime >= targetFrameTime) {
-            lastTime = currentTime;
-            
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            game->update(static_cast<float>(deltaTime));
-            game->render();
-
-            if (game->shouldExit()) {
-                glfwSetWindowShouldClose(window, GLFW_TRUE);
+        if (inputPlayer.isOpen()) {
+            glfwPollEvents();
+            if (!replayFrame(!launchOptions.replayFast)) {
+                std::cout << "Snimak je odigran." << std::endl;
+                break;
             }
+        }
+        else {
+            scheduler.waitForFrame();
+            dispatchInput(InputEvent::frame(Profiler::nowNs()));
+            drainInputSamples(window);
+            game->getLatencyTracker().poll();
 
+            while (scheduler.consumeStep()) {
+                dispatchInput(InputEvent::tick(scheduler.getStep()));
+            }
+        }
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        game->render();
+        game->getLatencyTracker().frameSubmitted();
+
+        if (game->shouldExit()) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+
+        {
+            PROFILE_ZONE("glfwSwapBuffers");
             glfwSwapBuffers(window);
         }
-        
-        glfwPollEvents();
+        game->getLatencyTracker().frameSwapped();
+        Profiler::endFrame();
+        GLStats::endFrame();
+        traceCapture.endFrame();
+    }
+
+    inputThread.stop();
+    if (inputThread.getDroppedSamples() > 0) {
+        std::cout << "Izgubljeno uzoraka misa (puna queue): " << inputThread.getDroppedSamples() << std::endl;
+    }
+
+    FramePacing pacing = scheduler.getPacing();
+    std::cout << "Frame pacing: " << pacing.fps << " fps, " << pacing.meanMs << " ms po frejmu, jitter "
+        << pacing.jitterMs << " ms, najvece odstupanje " << pacing.maxDeviationMs << " ms" << std::endl;
+
+    for (int stage = 0; stage < LatencyTracker::StageCount; stage++) {
+        LatencyTracker::Stage latencyStage = static_cast<LatencyTracker::Stage>(stage);
+        LatencyTracker::Distribution latency = game->getLatencyTracker().distribution(latencyStage);
+        std::cout << "Latencija klik -> " << LatencyTracker::stageName(latencyStage) << ": p50 " << latency.p50Ms
+            << " ms, p90 " << latency.p90Ms << " ms, p99 " << latency.p99Ms << " ms, max " << latency.maxMs
+            << " ms (" << latency.samples << " klikova)" << std::endl;
+    }
+
+    if (!launchOptions.gpuProfilePath.empty()) {
+        game->getGpuProfiler()->writeJson(launchOptions.gpuProfilePath);
+    }
+    if (!launchOptions.glStatsPath.empty()) {
+        GLStats::writeJson(launchOptions.glStatsPath);
+    }
+    traceCapture.finish();
+    if (inputRecorder.isRecording()) {
+        std::cout << "Snimljeno dogadjaja: " << inputRecorder.getEventCount() << " (" << launchOptions.recordPath << ")" << std::endl;
+        inputRecorder.finish();
     }
 
     delete game;
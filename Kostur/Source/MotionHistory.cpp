@@ -0,0 +1,31 @@
+#include "../Header/MotionHistory.h"
+
+void MotionHistory::record(uint64_t timeNs, float yaw, float pitch) {
+    entries[head] = { timeNs, yaw, pitch };
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY) {
+        count++;
+    }
+}
+
+bool MotionHistory::orientationAt(uint64_t timeNs, float& yaw, float& pitch) const {
+    if (count == 0 || at(0).timeNs > timeNs) {
+        return false;
+    }
+
+    // Last entry with time <= timeNs
+    int low = 0;
+    int high = count - 1;
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+        if (at(middle).timeNs <= timeNs) {
+            low = middle;
+        }
+        else {
+            high = middle - 1;
+        }
+    }
+    yaw = at(low).yaw;
+    pitch = at(low).pitch;
+    return true;
+}
@@ -147,7 +147,7 @@ void OBJLoader::setupMesh(OBJMesh& mesh) {
     glGenBuffers(1, &mesh.VBO);
     glGenBuffers(1, &mesh.EBO);
 
-    glBindVertexArray(mesh.VAO);
+    RenderState::bindVertexArray(mesh.VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
     glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(float),
@@ -173,7 +173,7 @@ void OBJLoader::setupMesh(OBJMesh& mesh) {
         (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    glBindVertexArray(0);
+    RenderState::bindVertexArray(0);
 
     // Check for OpenGL errors
     GLenum err = glGetError();
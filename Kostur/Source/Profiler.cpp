@@ -0,0 +1,156 @@
+#include "../Header/Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+namespace {
+    const uint32_t RING_SIZE = 4096;  // power of two
+
+    struct ThreadRing {
+        Profiler::Event events[RING_SIZE];
+        std::atomic<uint32_t> head;  // advanced by the owning thread
+        std::atomic<uint32_t> tail;  // advanced by endFrame
+
+        ThreadRing() : head(0), tail(0) {}
+    };
+
+    struct ZoneHistory {
+        const char* name;
+        double frameMs[Profiler::HISTORY_FRAMES];
+        int frameCalls[Profiler::HISTORY_FRAMES];
+        double currentMs;
+        int currentCalls;
+    };
+
+    // Rings live for the whole process so endFrame never reads one that was freed
+    std::mutex ringsMutex;
+    std::vector<ThreadRing*> rings;
+    std::atomic<uint64_t> dropped(0);
+    std::vector<Profiler::ThreadEvent>* eventSink = nullptr;
+
+    // Only touched by the thread that calls endFrame/collect
+    ZoneHistory zones[Profiler::MAX_ZONES];
+    int zoneCount = 0;
+    int frameCursor = 0;
+    int framesRecorded = 0;
+
+    ThreadRing& localRing() {
+        thread_local ThreadRing* ring = nullptr;
+        if (!ring) {
+            ring = new ThreadRing();
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            rings.push_back(ring);
+        }
+        return *ring;
+    }
+
+    ZoneHistory* findZone(const char* name) {
+        for (int i = 0; i < zoneCount; i++) {
+            if (zones[i].name == name || std::strcmp(zones[i].name, name) == 0) {
+                return &zones[i];
+            }
+        }
+        if (zoneCount == Profiler::MAX_ZONES) {
+            return nullptr;
+        }
+        ZoneHistory& zone = zones[zoneCount++];
+        zone.name = name;
+        std::fill(zone.frameMs, zone.frameMs + Profiler::HISTORY_FRAMES, 0.0);
+        std::fill(zone.frameCalls, zone.frameCalls + Profiler::HISTORY_FRAMES, 0);
+        zone.currentMs = 0.0;
+        zone.currentCalls = 0;
+        return &zone;
+    }
+}
+
+uint64_t Profiler::nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadRing& ring = localRing();
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head & (RING_SIZE - 1)] = { name, startNs, endNs };
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame() {
+    std::vector<ThreadRing*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        snapshot = rings;
+    }
+
+    for (size_t thread = 0; thread < snapshot.size(); thread++) {
+        ThreadRing* ring = snapshot[thread];
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            const Event& event = ring->events[tail & (RING_SIZE - 1)];
+            ZoneHistory* zone = findZone(event.name);
+            if (zone) {
+                zone->currentMs += (event.endNs - event.startNs) / 1.0e6;
+                zone->currentCalls++;
+            }
+            if (eventSink) {
+                eventSink->push_back({ event, static_cast<int>(thread) });
+            }
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+
+    for (int i = 0; i < zoneCount; i++) {
+        zones[i].frameMs[frameCursor] = zones[i].currentMs;
+        zones[i].frameCalls[frameCursor] = zones[i].currentCalls;
+        zones[i].currentMs = 0.0;
+        zones[i].currentCalls = 0;
+    }
+    frameCursor = (frameCursor + 1) % HISTORY_FRAMES;
+    framesRecorded = std::min(framesRecorded + 1, HISTORY_FRAMES);
+}
+
+void Profiler::collect(std::vector<ZoneStats>& out) {
+    out.clear();
+    if (framesRecorded == 0) {
+        return;
+    }
+
+    // The ring starts full of zeros, so only the recorded part is in the window
+    double samples[HISTORY_FRAMES];
+    for (int i = 0; i < zoneCount; i++) {
+        const ZoneHistory& zone = zones[i];
+        double sum = 0.0;
+        long long calls = 0;
+        for (int frame = 0; frame < framesRecorded; frame++) {
+            samples[frame] = zone.frameMs[frame];
+            sum += zone.frameMs[frame];
+            calls += zone.frameCalls[frame];
+        }
+        std::sort(samples, samples + framesRecorded);
+        int p99Index = std::max(0, static_cast<int>(std::ceil(0.99 * framesRecorded)) - 1);
+
+        ZoneStats stats;
+        stats.name = zone.name;
+        stats.minMs = samples[0];
+        stats.avgMs = sum / framesRecorded;
+        stats.p99Ms = samples[p99Index];
+        stats.callsPerFrame = static_cast<double>(calls) / framesRecorded;
+        out.push_back(stats);
+    }
+}
+
+uint64_t Profiler::droppedEvents() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void Profiler::setEventSink(std::vector<ThreadEvent>* sink) {
+    eventSink = sink;
+}
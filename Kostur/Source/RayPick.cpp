@@ -0,0 +1,255 @@
+#include "../Header/RayPick.h"
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KOSTUR_SSE2 1
+#endif
+
+namespace {
+    const float NO_HIT = std::numeric_limits<float>::infinity();
+
+    struct Ray {
+        float ox, oy, oz;
+        float dx, dy, dz;
+    };
+
+    Ray makeRay(const glm::vec3& origin, const glm::vec3& direction) {
+        glm::vec3 d = glm::normalize(direction);
+        return { origin.x, origin.y, origin.z, d.x, d.y, d.z };
+    }
+
+    // With L = center - origin and b = dot(L, d): a disc facing the origin is
+    // crossed at t = |L|^2 / b, at a distance^2 of |L|^2 (|L|^2 - b^2) / b^2 from
+    // its center. A sphere is entered at b - sqrt(r^2 - (|L|^2 - b^2)), or left at
+    // b + sqrt(...) when the origin is inside it.
+    float hitDistance(const Ray& ray, float cx, float cy, float cz, float radius, RayPick::Shape shape) {
+        float lx = cx - ray.ox;
+        float ly = cy - ray.oy;
+        float lz = cz - ray.oz;
+        float b = lx * ray.dx + ly * ray.dy + lz * ray.dz;
+        float ll = lx * lx + ly * ly + lz * lz;
+        float r2 = radius * radius;
+        if (shape == RayPick::Shape::Disc) {
+            if (b > 0.0f && ll * (ll - b * b) <= r2 * (b * b)) {
+                return ll / b;
+            }
+            return NO_HIT;
+        }
+        float h = r2 - (ll - b * b);
+        if (h < 0.0f) {
+            return NO_HIT;
+        }
+        float root = std::sqrt(h);
+        float t = b - root;
+        if (t > 0.0f) return t;
+        t = b + root;
+        return t > 0.0f ? t : NO_HIT;
+    }
+
+#if defined(__AVX2__)
+    const int LANES = 8;
+
+    // Hit distances of targets [first, first + 8), NO_HIT where missed; returns the hit lanes
+    unsigned chunkDistances(const Ray& ray, const float* x, const float* y, const float* z, const float* radii,
+                            int first, RayPick::Shape shape, float* t) {
+        __m256 lx = _mm256_sub_ps(_mm256_loadu_ps(x + first), _mm256_set1_ps(ray.ox));
+        __m256 ly = _mm256_sub_ps(_mm256_loadu_ps(y + first), _mm256_set1_ps(ray.oy));
+        __m256 lz = _mm256_sub_ps(_mm256_loadu_ps(z + first), _mm256_set1_ps(ray.oz));
+        __m256 r = _mm256_loadu_ps(radii + first);
+        __m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lx, _mm256_set1_ps(ray.dx)),
+            _mm256_mul_ps(ly, _mm256_set1_ps(ray.dy))), _mm256_mul_ps(lz, _mm256_set1_ps(ray.dz)));
+        __m256 ll = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lx, lx), _mm256_mul_ps(ly, ly)), _mm256_mul_ps(lz, lz));
+        __m256 r2 = _mm256_mul_ps(r, r);
+        __m256 bb = _mm256_mul_ps(b, b);
+        __m256 zero = _mm256_setzero_ps();
+        __m256 noHit = _mm256_set1_ps(NO_HIT);
+
+        __m256 distance;
+        if (shape == RayPick::Shape::Disc) {
+            __m256 inside = _mm256_and_ps(_mm256_cmp_ps(b, zero, _CMP_GT_OQ),
+                _mm256_cmp_ps(_mm256_mul_ps(ll, _mm256_sub_ps(ll, bb)), _mm256_mul_ps(r2, bb), _CMP_LE_OQ));
+            distance = _mm256_blendv_ps(noHit, _mm256_div_ps(ll, b), inside);
+        }
+        else {
+            __m256 h = _mm256_sub_ps(r2, _mm256_sub_ps(ll, bb));
+            __m256 crossed = _mm256_cmp_ps(h, zero, _CMP_GE_OQ);
+            __m256 root = _mm256_sqrt_ps(_mm256_max_ps(h, zero));
+            __m256 enter = _mm256_sub_ps(b, root);
+            __m256 leave = _mm256_add_ps(b, root);
+            __m256 nearT = _mm256_blendv_ps(leave, enter, _mm256_cmp_ps(enter, zero, _CMP_GT_OQ));
+            distance = _mm256_blendv_ps(noHit, nearT, _mm256_and_ps(crossed, _mm256_cmp_ps(nearT, zero, _CMP_GT_OQ)));
+        }
+        _mm256_storeu_ps(t, distance);
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(distance, noHit, _CMP_LT_OQ)));
+    }
+#elif defined(KOSTUR_SSE2)
+    const int LANES = 4;
+
+    __m128 select(__m128 mask, __m128 ifTrue, __m128 ifFalse) {
+        return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+    }
+
+    unsigned chunkDistances(const Ray& ray, const float* x, const float* y, const float* z, const float* radii,
+                            int first, RayPick::Shape shape, float* t) {
+        __m128 lx = _mm_sub_ps(_mm_loadu_ps(x + first), _mm_set1_ps(ray.ox));
+        __m128 ly = _mm_sub_ps(_mm_loadu_ps(y + first), _mm_set1_ps(ray.oy));
+        __m128 lz = _mm_sub_ps(_mm_loadu_ps(z + first), _mm_set1_ps(ray.oz));
+        __m128 r = _mm_loadu_ps(radii + first);
+        __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, _mm_set1_ps(ray.dx)),
+            _mm_mul_ps(ly, _mm_set1_ps(ray.dy))), _mm_mul_ps(lz, _mm_set1_ps(ray.dz)));
+        __m128 ll = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, lx), _mm_mul_ps(ly, ly)), _mm_mul_ps(lz, lz));
+        __m128 r2 = _mm_mul_ps(r, r);
+        __m128 bb = _mm_mul_ps(b, b);
+        __m128 zero = _mm_setzero_ps();
+        __m128 noHit = _mm_set1_ps(NO_HIT);
+
+        __m128 distance;
+        if (shape == RayPick::Shape::Disc) {
+            __m128 inside = _mm_and_ps(_mm_cmpgt_ps(b, zero),
+                _mm_cmple_ps(_mm_mul_ps(ll, _mm_sub_ps(ll, bb)), _mm_mul_ps(r2, bb)));
+            distance = select(inside, _mm_div_ps(ll, b), noHit);
+        }
+        else {
+            __m128 h = _mm_sub_ps(r2, _mm_sub_ps(ll, bb));
+            __m128 crossed = _mm_cmpge_ps(h, zero);
+            __m128 root = _mm_sqrt_ps(_mm_max_ps(h, zero));
+            __m128 enter = _mm_sub_ps(b, root);
+            __m128 leave = _mm_add_ps(b, root);
+            __m128 nearT = select(_mm_cmpgt_ps(enter, zero), enter, leave);
+            distance = select(_mm_and_ps(crossed, _mm_cmpgt_ps(nearT, zero)), nearT, noHit);
+        }
+        _mm_storeu_ps(t, distance);
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(distance, noHit)));
+    }
+#else
+    const int LANES = 1;
+
+    unsigned chunkDistances(const Ray& ray, const float* x, const float* y, const float* z, const float* radii,
+                            int first, RayPick::Shape shape, float* t) {
+        t[0] = hitDistance(ray, x[first], y[first], z[first], radii[first], shape);
+        return t[0] < NO_HIT ? 1u : 0u;
+    }
+#endif
+
+    // Hits are rare, so the spawn-time check and the running minimum stay scalar
+    void keepNearest(unsigned lanes, const float* t, int first, const uint64_t* spawnTimes,
+                     uint64_t maxSpawnNs, RayPick::Hit& best) {
+        for (; lanes != 0; lanes &= lanes - 1) {
+            int lane = 0;
+            while (!((lanes >> lane) & 1)) {
+                lane++;
+            }
+            if (t[lane] < best.t && spawnTimes[first + lane] <= maxSpawnNs) {
+                best.index = first + lane;
+                best.t = t[lane];
+            }
+        }
+    }
+}
+
+RayPick::Hit RayPick::nearest(const TargetPool& targets, const glm::vec3& origin, const glm::vec3& direction,
+                              Shape shape, uint64_t maxSpawnNs) {
+    Hit best = { -1, NO_HIT };
+    nearestMany(targets, origin, &direction, &maxSpawnNs, 1, shape, &best);
+    return best;
+}
+
+RayPick::Hit RayPick::nearestScalar(const TargetPool& targets, const glm::vec3& origin, const glm::vec3& direction,
+                                    Shape shape, uint64_t maxSpawnNs) {
+    Ray ray = makeRay(origin, direction);
+    const float* x = targets.getPositionX();
+    const float* y = targets.getPositionY();
+    const float* z = targets.getPositionZ();
+    const float* radii = targets.getRadii();
+    const uint64_t* spawnTimes = targets.getSpawnTimes();
+
+    Hit best = { -1, NO_HIT };
+    for (int i = 0; i < targets.size(); i++) {
+        float t = hitDistance(ray, x[i], y[i], z[i], radii[i], shape);
+        if (t < best.t && spawnTimes[i] <= maxSpawnNs) {
+            best.index = i;
+            best.t = t;
+        }
+    }
+    return best;
+}
+
+RayPick::Hit RayPick::nearestIndexed(const TargetPool& targets, const glm::vec3& origin, const glm::vec3& direction,
+                                     Shape shape, uint64_t maxSpawnNs) {
+    // Below this a flat vector scan is cheaper than walking the cells (--pick-bench)
+    const int MIN_INDEXED_TARGETS = 64;
+    if (targets.size() < MIN_INDEXED_TARGETS) {
+        return nearest(targets, origin, direction, shape, maxSpawnNs);
+    }
+
+    Ray ray = makeRay(origin, direction);
+    const float* x = targets.getPositionX();
+    const float* y = targets.getPositionY();
+    const float* z = targets.getPositionZ();
+    const float* radii = targets.getRadii();
+    const uint64_t* spawnTimes = targets.getSpawnTimes();
+
+    // Cells come in no particular order, so ties are settled by index as in the full scan
+    Hit best = { -1, NO_HIT };
+    targets.getGrid().forEachAlongRay(origin, glm::vec3(ray.dx, ray.dy, ray.dz), [&](int i) {
+        float t = hitDistance(ray, x[i], y[i], z[i], radii[i], shape);
+        if ((t < best.t || (t == best.t && t < NO_HIT && i < best.index)) && spawnTimes[i] <= maxSpawnNs) {
+            best.index = i;
+            best.t = t;
+        }
+    });
+    return best;
+}
+
+void RayPick::nearestMany(const TargetPool& targets, const glm::vec3& origin, const glm::vec3* directions,
+                          const uint64_t* maxSpawnNs, int rayCount, Shape shape, Hit* hits) {
+    const int MAX_RAYS = 16;
+    const float* x = targets.getPositionX();
+    const float* y = targets.getPositionY();
+    const float* z = targets.getPositionZ();
+    const float* radii = targets.getRadii();
+    const uint64_t* spawnTimes = targets.getSpawnTimes();
+    int count = targets.size();
+
+    // Up to 16 rays per pass, so each block of targets is loaded once for all of them
+    for (int firstRay = 0; firstRay < rayCount; firstRay += MAX_RAYS) {
+        int batch = rayCount - firstRay < MAX_RAYS ? rayCount - firstRay : MAX_RAYS;
+        Ray rays[MAX_RAYS];
+        uint64_t limits[MAX_RAYS];
+        for (int r = 0; r < batch; r++) {
+            rays[r] = makeRay(origin, directions[firstRay + r]);
+            limits[r] = maxSpawnNs ? maxSpawnNs[firstRay + r] : ANY_SPAWN_TIME;
+            hits[firstRay + r] = { -1, NO_HIT };
+        }
+
+        float t[LANES];
+        int i = 0;
+        for (; i + LANES <= count; i += LANES) {
+            for (int r = 0; r < batch; r++) {
+                unsigned lanes = chunkDistances(rays[r], x, y, z, radii, i, shape, t);
+                if (lanes != 0) {
+                    keepNearest(lanes, t, i, spawnTimes, limits[r], hits[firstRay + r]);
+                }
+            }
+        }
+        for (; i < count; i++) {
+            for (int r = 0; r < batch; r++) {
+                float distance = hitDistance(rays[r], x[i], y[i], z[i], radii[i], shape);
+                Hit& best = hits[firstRay + r];
+                if (distance < best.t && spawnTimes[i] <= limits[r]) {
+                    best.index = i;
+                    best.t = distance;
+                }
+            }
+        }
+    }
+}
+
+bool RayPick::intersect(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& center,
+                        float radius, Shape shape, float& t) {
+    t = hitDistance(makeRay(origin, direction), center.x, center.y, center.z, radius, shape);
+    return t < NO_HIT;
+}
@@ -0,0 +1,217 @@
+#include "../Header/RenderState.h"
+#include "../Header/GLStats.h"
+
+namespace {
+    const unsigned int UNKNOWN = 0xFFFFFFFFu;  // never a valid GL name or enum
+    const int TEXTURE_TARGETS = 2;             // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY
+
+    enum Capability { CAP_DEPTH_TEST, CAP_CULL_FACE, CAP_BLEND, CAP_COUNT };
+
+    struct State {
+        unsigned int program;
+        unsigned int vao;
+        unsigned int activeUnit;
+        unsigned int textures[RenderState::MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+        int enabled[CAP_COUNT];  // -1 unknown
+        GLenum blendSource, blendDestination;
+        GLenum depthFunc;
+        GLenum cullFace;
+        GLenum frontFace;
+    };
+
+    State state;
+    RenderState::Stats stats = { 0, 0 };
+    bool initialized = false;
+
+    void ensureInitialized() {
+        if (!initialized) {
+            RenderState::reset();
+        }
+    }
+
+    // Counts the call and tells whether it has to reach GL
+    bool changes(unsigned int& cached, unsigned int value) {
+        if (cached == value) {
+            stats.elided++;
+            return false;
+        }
+        cached = value;
+        stats.issued++;
+        return true;
+    }
+
+    int capabilityIndex(GLenum capability) {
+        switch (capability) {
+        case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+        case GL_CULL_FACE: return CAP_CULL_FACE;
+        case GL_BLEND: return CAP_BLEND;
+        default: return -1;
+        }
+    }
+
+    int textureTargetIndex(GLenum target) {
+        switch (target) {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        default: return -1;
+        }
+    }
+
+    void activateUnit(unsigned int unit) {
+        if (changes(state.activeUnit, unit)) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+        }
+    }
+}
+
+void RenderState::reset() {
+    state.program = UNKNOWN;
+    state.vao = UNKNOWN;
+    state.activeUnit = UNKNOWN;
+    for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+        for (int target = 0; target < TEXTURE_TARGETS; target++) {
+            state.textures[unit][target] = UNKNOWN;
+        }
+    }
+    for (int cap = 0; cap < CAP_COUNT; cap++) {
+        state.enabled[cap] = -1;
+    }
+    state.blendSource = UNKNOWN;
+    state.blendDestination = UNKNOWN;
+    state.depthFunc = UNKNOWN;
+    state.cullFace = UNKNOWN;
+    state.frontFace = UNKNOWN;
+    initialized = true;
+}
+
+void RenderState::beginFrame() {
+    stats.issued = 0;
+    stats.elided = 0;
+}
+
+RenderState::Stats RenderState::frameStats() {
+    return stats;
+}
+
+void RenderState::useProgram(unsigned int program) {
+    ensureInitialized();
+    if (changes(state.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void RenderState::bindVertexArray(unsigned int vao) {
+    ensureInitialized();
+    if (changes(state.vao, vao)) {
+        glBindVertexArray(vao);
+    }
+}
+
+void RenderState::bindTexture(unsigned int unit, GLenum target, unsigned int texture) {
+    ensureInitialized();
+    int targetIndex = textureTargetIndex(target);
+    if (unit >= static_cast<unsigned int>(MAX_TEXTURE_UNITS) || targetIndex < 0) {
+        activateUnit(unit);
+        glBindTexture(target, texture);
+        GLStats::countTextureBind();
+        stats.issued++;
+        return;
+    }
+
+    if (state.textures[unit][targetIndex] == texture) {
+        stats.elided++;
+        return;
+    }
+    activateUnit(unit);
+    changes(state.textures[unit][targetIndex], texture);
+    glBindTexture(target, texture);
+    GLStats::countTextureBind();
+}
+
+void RenderState::setEnabled(GLenum capability, bool enabled) {
+    ensureInitialized();
+    int index = capabilityIndex(capability);
+    if (index >= 0) {
+        if (state.enabled[index] == (enabled ? 1 : 0)) {
+            stats.elided++;
+            return;
+        }
+        state.enabled[index] = enabled ? 1 : 0;
+    }
+    stats.issued++;
+    if (enabled) {
+        glEnable(capability);
+    }
+    else {
+        glDisable(capability);
+    }
+}
+
+void RenderState::blendFunc(GLenum source, GLenum destination) {
+    ensureInitialized();
+    if (state.blendSource == source && state.blendDestination == destination) {
+        stats.elided++;
+        return;
+    }
+    state.blendSource = source;
+    state.blendDestination = destination;
+    stats.issued++;
+    glBlendFunc(source, destination);
+}
+
+void RenderState::depthFunc(GLenum func) {
+    ensureInitialized();
+    if (changes(state.depthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void RenderState::cullFace(GLenum face) {
+    ensureInitialized();
+    if (changes(state.cullFace, face)) {
+        glCullFace(face);
+    }
+}
+
+void RenderState::frontFace(GLenum mode) {
+    ensureInitialized();
+    if (changes(state.frontFace, mode)) {
+        glFrontFace(mode);
+    }
+}
+
+// Deleting a bound object resets that binding to 0 in GL, so the cache follows
+void RenderState::deleteProgram(unsigned int program) {
+    if (program == 0) {
+        return;
+    }
+    glDeleteProgram(program);
+    if (state.program == program) {
+        state.program = UNKNOWN;  // a bound program is only flagged for deletion
+    }
+}
+
+void RenderState::deleteVertexArrays(int count, const unsigned int* vaos) {
+    glDeleteVertexArrays(count, vaos);
+    for (int i = 0; i < count; i++) {
+        if (vaos[i] != 0 && state.vao == vaos[i]) {
+            state.vao = 0;
+        }
+    }
+}
+
+void RenderState::deleteTextures(int count, const unsigned int* textures) {
+    glDeleteTextures(count, textures);
+    for (int i = 0; i < count; i++) {
+        if (textures[i] == 0) {
+            continue;
+        }
+        for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+            for (int target = 0; target < TEXTURE_TARGETS; target++) {
+                if (state.textures[unit][target] == textures[i]) {
+                    state.textures[unit][target] = 0;
+                }
+            }
+        }
+    }
+}
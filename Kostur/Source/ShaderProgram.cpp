@@ -0,0 +1,159 @@
+#include "../Header/ShaderProgram.h"
+#include "../Header/RenderState.h"
+#include "../Header/Util.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+ShaderProgram::ShaderProgram(const char* vsSource, const char* fsSource)
+    : id(createShader(vsSource, fsSource))
+{
+    reflectUniforms();
+}
+
+ShaderProgram::~ShaderProgram() {
+    RenderState::deleteProgram(id);
+}
+
+void ShaderProgram::reflectUniforms() {
+    int activeCount = 0;
+    int maxNameLength = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &activeCount);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameBuffer(std::max(maxNameLength, 1));
+    int maxLocation = -1;
+
+    for (int i = 0; i < activeCount; i++) {
+        int nameLength = 0;
+        int arraySize = 0;
+        GLenum type = 0;
+        glGetActiveUniform(id, i, static_cast<GLsizei>(nameBuffer.size()), &nameLength, &arraySize, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), nameLength);
+        int location = glGetUniformLocation(id, name.c_str());
+        if (location < 0) {
+            continue; // Uniform block member, set through its buffer
+        }
+
+        // Arrays are reported as "name[0]", look them up by their plain name
+        size_t bracket = name.find('[');
+        if (bracket != std::string::npos) {
+            name.resize(bracket);
+        }
+
+        Uniform uniform;
+        uniform.name = name;
+        uniform.location = location;
+        uniform.type = type;
+        uniform.hasValue = false;
+        switch (type) {
+        case GL_FLOAT_VEC2: uniform.valueCount = 2; break;
+        case GL_FLOAT_VEC3: uniform.valueCount = 3; break;
+        case GL_FLOAT_VEC4: uniform.valueCount = 4; break;
+        case GL_FLOAT_MAT3: uniform.valueCount = 9; break;
+        case GL_FLOAT_MAT4: uniform.valueCount = 16; break;
+        default: uniform.valueCount = 1; break;
+        }
+        std::memset(uniform.value, 0, sizeof(uniform.value));
+
+        uniforms.push_back(uniform);
+        maxLocation = std::max(maxLocation, location);
+    }
+
+    std::sort(uniforms.begin(), uniforms.end(),
+        [](const Uniform& a, const Uniform& b) { return a.name < b.name; });
+
+    uniformIndexByLocation.assign(maxLocation + 1, -1);
+    for (size_t i = 0; i < uniforms.size(); i++) {
+        uniformIndexByLocation[uniforms[i].location] = static_cast<int>(i);
+    }
+}
+
+void ShaderProgram::use() const {
+    RenderState::useProgram(id);
+}
+
+int ShaderProgram::getUniformLocation(const char* name) const {
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+        [](const Uniform& uniform, const char* key) { return std::strcmp(uniform.name.c_str(), key) < 0; });
+    if (it == uniforms.end() || it->name != name) {
+        return -1;
+    }
+    return it->location;
+}
+
+void ShaderProgram::bindUniformBlock(const char* blockName, unsigned int bindingPoint) const {
+    unsigned int blockIndex = glGetUniformBlockIndex(id, blockName);
+    if (blockIndex == GL_INVALID_INDEX) {
+        return;
+    }
+    glUniformBlockBinding(id, blockIndex, bindingPoint);
+}
+
+// Returns false when the program already holds this value and the upload can be skipped
+bool ShaderProgram::updateCache(int location, const void* data, int valueCount) {
+    if (location < 0) {
+        return false;
+    }
+    if (location >= static_cast<int>(uniformIndexByLocation.size()) || uniformIndexByLocation[location] < 0) {
+        return true;
+    }
+
+    Uniform& uniform = uniforms[uniformIndexByLocation[location]];
+    size_t bytes = sizeof(float) * std::min(valueCount, 16);
+    if (uniform.hasValue && std::memcmp(uniform.value, data, bytes) == 0) {
+        return false;
+    }
+    std::memcpy(uniform.value, data, bytes);
+    uniform.hasValue = true;
+    return true;
+}
+
+void ShaderProgram::setInt(int location, int value) {
+    if (updateCache(location, &value, 1)) {
+        glUniform1i(location, value);
+    }
+}
+
+void ShaderProgram::setFloat(int location, float value) {
+    if (updateCache(location, &value, 1)) {
+        glUniform1f(location, value);
+    }
+}
+
+void ShaderProgram::setVec3(int location, float x, float y, float z) {
+    float value[3] = { x, y, z };
+    if (updateCache(location, value, 3)) {
+        glUniform3fv(location, 1, value);
+    }
+}
+
+void ShaderProgram::setVec3(int location, const glm::vec3& value) {
+    if (updateCache(location, glm::value_ptr(value), 3)) {
+        glUniform3fv(location, 1, glm::value_ptr(value));
+    }
+}
+
+void ShaderProgram::setMat4(int location, const float* value) {
+    if (updateCache(location, value, 16)) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, value);
+    }
+}
+
+void ShaderProgram::setMat4(int location, const glm::mat4& value) {
+    setMat4(location, glm::value_ptr(value));
+}
+
+ShaderProgram* ShaderRegistry::acquire(const char* vsSource, const char* fsSource) {
+    std::string key = std::string(vsSource) + "|" + fsSource;
+    auto it = programs.find(key);
+    if (it != programs.end()) {
+        return it->second.get();
+    }
+
+    ShaderProgram* program = new ShaderProgram(vsSource, fsSource);
+    programs[key] = std::unique_ptr<ShaderProgram>(program);
+    return program;
+}
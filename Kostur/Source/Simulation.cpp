@@ -0,0 +1,403 @@
+#include "../Header/Simulation.h"
+#include "../Header/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+Simulation::Simulation(const SimClock& simClock, uint64_t seed)
+    : clock(simClock), random(seed), loggingEnabled(true),
+    camera(glm::vec3(0.0f, 0.0f, 3.0f)), targets(MAX_TARGETS, ROOM_HALF_WIDTH, ROOM_HALF_HEIGHT, ROOM_HALF_DEPTH),
+    recentlyExpired(EXPIRED_HISTORY),
+    // Targets of radius 1 kept 3.5 from the wall edges
+    spawnSampler(ROOM_HALF_WIDTH, ROOM_HALF_HEIGHT, ROOM_HALF_DEPTH, 3.5f, 1.0f, seed),
+    score(0), lives(3), maxLives(3), hitCount(0), totalClicks(0), lateHits(0),
+    totalHitTime(0.0), survivalTime(0.0), avgHitSpeed(0.0), gameOver(false), spawnTimer(0.0f),
+    spawnInterval(1.5f), initialSpawnInterval(1.5f), minSpawnInterval(0.3f),
+    targetLifeTimeMultiplier(1.0f), minTargetLifeTime(0.4f),
+    fireMode(FireMode::USP), triggerHeld(false), fireRate(0.1), shotsFired(0),
+    simTime(0.0), timelineTime(0.0), timelineNs(simClock.nowNs()), frameNs(simClock.nowNs()), lastStepNs(0),
+    triggerPressTime(0.0), triggerPressNs(0), triggerReleaseTime(0.0), nextShotTime(0.0)
+{
+    glm::vec3 spawnZoneCenter(0.0f, 0.0f, -6.5f);
+    camera.lookAt(spawnZoneCenter);
+    // Seeded so clicks before the first mouse report still find an orientation
+    motionHistory.record(clock.nowNs(), camera.getYaw(), camera.getPitch());
+
+    // AK-47 bottom right, USP-S bottom left, both on the front wall
+    weaponPickups.push_back({ glm::vec3(7.0f, -3.5f, -9.5f), glm::vec3(150.0f), true });
+    weaponPickups.push_back({ glm::vec3(-8.5f, -3.5f, -9.5f), glm::vec3(150.0f), false });
+
+    startNs = clock.nowNs();
+    lastHitNs = startNs;
+}
+
+double Simulation::secondsSince(uint64_t timeNs) const {
+    uint64_t now = clock.nowNs();
+    return now > timeNs ? (now - timeNs) * 1e-9 : 0.0;
+}
+
+uint64_t Simulation::timelineNsAt(double time) const {
+    double offsetNs = (time - timelineTime) * 1e9;
+    return offsetNs >= 0.0 ? timelineNs + static_cast<uint64_t>(offsetNs) : timelineNs - static_cast<uint64_t>(-offsetNs);
+}
+
+// Once the clock moves on, the ticks run under the previous reading are done, and they
+// end within a step of it. Further apart, the frame loop dropped time (or the game was
+// over and did not tick): the timeline picks up again at that reading
+void Simulation::syncTimeline() {
+    uint64_t now = clock.nowNs();
+    if (now == frameNs) return;
+    uint64_t standsNs = timelineNsAt(simTime);
+    uint64_t driftNs = standsNs > frameNs ? standsNs - frameNs : frameNs - standsNs;
+    if (driftNs > lastStepNs) {
+        timelineTime = simTime;
+        timelineNs = frameNs;
+    }
+    frameNs = now;
+}
+
+void Simulation::restart() {
+    score = 0;
+    lives = 3;
+    gameOver = false;
+    spawnTimer = 0.0f;
+    spawnInterval = initialSpawnInterval;
+    targetLifeTimeMultiplier = 1.0f;
+    hitCount = 0;
+    totalHitTime = 0.0;
+    survivalTime = 0.0;
+    avgHitSpeed = 0.0;
+    totalClicks = 0;
+    lateHits = 0;
+
+    targets.clear();
+    recentlyExpired.clear();
+
+    // A trigger held into game over does not carry into the new game
+    triggerHeld = false;
+    triggerPressTime = simTime;
+    triggerReleaseTime = simTime;
+    nextShotTime = simTime;
+
+    startNs = clock.nowNs();
+    timelineTime = simTime;
+    timelineNs = startNs;
+    frameNs = startNs;
+    lastHitNs = startNs;
+}
+
+void Simulation::tick(float deltaTime) {
+    PROFILE_ZONE("Simulation::tick");
+    syncTimeline();
+    lastStepNs = static_cast<uint64_t>(deltaTime * 1e9);
+    if (gameOver) return;
+
+    // Every shot due in (simTime, simTime + deltaTime], each with its own time and aim,
+    // including shots due before a release that was already processed
+    double intervalEnd = simTime + deltaTime;
+    if (fireMode == FireMode::AK47) {
+        Shot shots[MAX_SHOTS_PER_TICK];
+        int shotCount = 0;
+        while (nextShotTime <= intervalEnd && nextShotTime < triggerReleaseTime) {
+            uint64_t shotTimeNs = timelineNsAt(nextShotTime);
+            shots[shotCount++] = { shotTimeNs, aimAt(shotTimeNs) };
+            nextShotTime += fireRate;
+            if (shotCount == MAX_SHOTS_PER_TICK) {
+                fireShots(shots, shotCount, nullptr);
+                shotCount = 0;
+            }
+        }
+        fireShots(shots, shotCount, nullptr);
+    }
+    simTime = intervalEnd;
+
+    updateDifficulty();
+
+    spawnTimer += deltaTime;
+    if (spawnTimer >= spawnInterval && spawnTarget()) {
+        spawnTimer = 0.0f;
+    }
+
+    if (targets.age(deltaTime) == 0) return;
+
+    // Ran out at the end of this step, on the timeline the shots of later steps are timed on
+    uint64_t expiredAtNs = timelineNsAt(simTime);
+    // In index order, so the lives lost and the expiry history do not depend on how the mask is built
+    const std::vector<uint64_t>& expiredMask = targets.getExpiredMask();
+    for (size_t w = 0; w < expiredMask.size(); w++) {
+        for (uint64_t word = expiredMask[w]; word != 0; word &= word - 1) {
+            int bit = 0;
+            while (!((word >> bit) & 1)) {
+                bit++;
+            }
+            int index = static_cast<int>(w * 64) + bit;
+
+            lives--;
+            if (recentlyExpired.full()) {
+                int oldest = 0;
+                for (int e = 1; e < recentlyExpired.size(); e++) {
+                    if (recentlyExpired.at(e).expiredAtNs < recentlyExpired.at(oldest).expiredAtNs) {
+                        oldest = e;
+                    }
+                }
+                recentlyExpired.destroyAt(oldest);
+            }
+            recentlyExpired.create({ targets.getHandle(index), targets.getPosition(index), targets.getRadius(index),
+                targets.getSpawnTimeNs(index), expiredAtNs });
+
+            if (lives <= 0) {
+                gameOver = true;
+                survivalTime = secondsSince(startNs);
+                if (hitCount > 0) {
+                    avgHitSpeed = totalHitTime / hitCount;
+                }
+            }
+        }
+    }
+    targets.removeExpired();
+}
+
+void Simulation::updateDifficulty() {
+    PROFILE_ZONE("Simulation::updateDifficulty");
+    double elapsedTime = secondsSince(startNs);
+
+    float difficultyFactor = static_cast<float>(elapsedTime) / 5.0f;
+
+    spawnInterval = initialSpawnInterval - (difficultyFactor * 0.2f);
+    if (spawnInterval < minSpawnInterval) {
+        spawnInterval = minSpawnInterval;
+    }
+
+    targetLifeTimeMultiplier = 1.0f - (difficultyFactor * 0.12f);
+    if (targetLifeTimeMultiplier < minTargetLifeTime) {
+        targetLifeTimeMultiplier = minTargetLifeTime;
+    }
+}
+
+// False when every spawn point in view is taken or the pool is full; tick() then tries again on the next step
+bool Simulation::spawnTarget() {
+    PROFILE_ZONE("Simulation::spawnTarget");
+    glm::vec3 targetPos;
+    if (targets.full() || !spawnSampler.sample(camera, targets, random, targetPos)) {
+        return false;
+    }
+
+    float lifeTime = (2.0f + random.nextFloat() * 2.0f) * targetLifeTimeMultiplier;
+    int skin = static_cast<int>(random.nextBelow(2));
+    targets.add(targetPos, spawnSampler.getRadius(), lifeTime, skin, timelineNsAt(simTime));
+    return true;
+}
+
+Simulation::ShotResult Simulation::click(uint64_t timeNs) {
+    Shot shot = { timeNs != 0 ? timeNs : clock.nowNs(), aimAt(timeNs) };
+    ShotResult result;
+    fireShots(&shot, 1, &result);
+    return result;
+}
+
+void Simulation::pressTrigger(uint64_t timeNs) {
+    triggerHeld = true;
+    // The press is the first shot; full-auto continues from here on the simulated timeline
+    triggerPressTime = simTime;
+    triggerPressNs = timeNs != 0 ? timeNs : clock.nowNs();
+    triggerReleaseTime = std::numeric_limits<double>::infinity();
+    nextShotTime = simTime + fireRate;
+}
+
+void Simulation::releaseTrigger(uint64_t timeNs) {
+    if (!triggerHeld) return;
+    triggerHeld = false;
+    syncTimeline();
+
+    // Shots due before the release still fire, even if tick() has not reached them yet
+    uint64_t releaseNs = timeNs != 0 ? timeNs : clock.nowNs();
+    double heldSeconds = releaseNs > triggerPressNs ? (releaseNs - triggerPressNs) * 1e-9 : 0.0;
+    // Time the frame loop dropped after a stall was held but never simulated; measured
+    // from where the simulation stands, the release cannot add shots for it
+    uint64_t simTimeNs = timelineNsAt(simTime);
+    double aheadSeconds = releaseNs > simTimeNs ? (releaseNs - simTimeNs) * 1e-9 : 0.0;
+    triggerReleaseTime = std::min(triggerPressTime + heldSeconds, simTime + aheadSeconds);
+}
+
+void Simulation::look(float xoffset, float yoffset, uint64_t timeNs) {
+    if (!gameOver) {
+        camera.processMouseMovement(xoffset, yoffset);
+        motionHistory.record(timeNs != 0 ? timeNs : clock.nowNs(), camera.getYaw(), camera.getPitch());
+    }
+}
+
+void Simulation::setFireMode(FireMode mode) {
+    fireMode = mode;
+    if (!loggingEnabled) return;
+    if (mode == FireMode::USP) {
+        std::cout << "\n[WEAPON] USP-S (Semi-Auto)" << std::endl;
+    }
+    else {
+        std::cout << "\n[WEAPON] AK-47 (Full-Auto)" << std::endl;
+    }
+}
+
+// Resolves shots in time order: wall weapons first, then live targets, then targets
+// that ran out after the shot was fired
+void Simulation::fireShots(const Shot* shots, int count, ShotResult* results) {
+    PROFILE_ZONE("Simulation::fireShots");
+    if (count == 0) return;
+
+    shotsFired += count;
+    uint64_t nowNs = clock.nowNs();
+    glm::vec3 rayOrigin = camera.getPosition();
+    for (int i = 0; i < count; i++) {
+        const glm::vec3& rayDir = shots[i].direction;
+        uint64_t shotTimeNs = shots[i].timeNs;
+        ShotResult result = ShotResult::Miss;
+
+        // PRVO: Provjeri da li je pogođeno oružje na zidu (MNOGO MANJI hitbox)
+        for (const WeaponPickup& weapon : weaponPickups) {
+            // SMANJENI hitbox na samo 1.5% originalne veličine (bilo je 5%)
+            glm::vec3 weaponMin = weapon.position - weapon.scale * 0.004f;
+            glm::vec3 weaponMax = weapon.position + weapon.scale * 0.004f;
+
+            if (rayAABBIntersection(rayOrigin, rayDir, weaponMin, weaponMax)) {
+                if (weapon.isAK && fireMode != FireMode::AK47) {
+                    setFireMode(FireMode::AK47);
+                    if (loggingEnabled) std::cout << "✓ Picked up AK-47 from the wall!" << std::endl;
+                }
+                else if (!weapon.isAK && fireMode != FireMode::USP) {
+                    setFireMode(FireMode::USP);
+                    if (loggingEnabled) std::cout << "✓ Picked up USP-S from the wall!" << std::endl;
+                }
+                result = ShotResult::Pickup;
+                break;
+            }
+        }
+
+        // DRUGO: Brojanje klika (samo ako nije oružje)
+        if (result != ShotResult::Pickup) {
+            totalClicks++;
+
+            // TREĆE: Provjeri da li je pogođen target
+            // The nearest disc as drawn; targets that appeared after the shot could not have been aimed at
+            RayPick::Hit hit = RayPick::nearestIndexed(targets, rayOrigin, rayDir, RayPick::Shape::Disc, shotTimeNs);
+
+            // Targets the shot came before, but tick() expired first, were still standing when it was
+            // fired: they compete on distance with the live ones
+            int expiredHit = -1;
+            float nearestT = hit.index >= 0 ? hit.t : std::numeric_limits<float>::infinity();
+            for (int e = 0; e < recentlyExpired.size(); e++) {
+                const ExpiredTarget& expired = recentlyExpired.at(e);
+                float distance;
+                if (expired.expiredAtNs > shotTimeNs && expired.spawnTimeNs <= shotTimeNs
+                    && RayPick::intersect(rayOrigin, rayDir, expired.position, expired.radius, RayPick::Shape::Disc, distance)
+                    && distance < nearestT) {
+                    nearestT = distance;
+                    expiredHit = e;
+                }
+            }
+
+            if (expiredHit >= 0) {
+                // Count the hit, return the life it cost
+                recentlyExpired.destroyAt(expiredHit);
+                lives = std::min(lives + 1, maxLives);
+                lateHits++;
+                result = ShotResult::Hit;
+                registerHit(nowNs);
+            }
+            else if (hit.index >= 0) {
+                targets.remove(hit.index);
+                result = ShotResult::Hit;
+                registerHit(nowNs);
+            }
+        }
+
+        if (results) {
+            results[i] = result;
+        }
+    }
+}
+
+// Aim at the shot's own time, from the motion history. Shots without a time (timeNs = 0) use the current aim
+glm::vec3 Simulation::aimAt(uint64_t timeNs) const {
+    float yaw, pitch;
+    if (timeNs != 0 && motionHistory.orientationAt(timeNs, yaw, pitch)) {
+        return Camera::frontFromAngles(yaw, pitch);
+    }
+    return camera.getFront();
+}
+
+void Simulation::registerHit(uint64_t nowNs) {
+    score++;
+
+    double timeSinceLastHit = nowNs > lastHitNs ? (nowNs - lastHitNs) * 1e-9 : 0.0;
+    totalHitTime += timeSinceLastHit;
+    hitCount++;
+    lastHitNs = nowNs;
+
+    if (loggingEnabled) {
+        std::cout << "\nHIT! Pogodaka: " << score << std::endl;
+    }
+}
+
+namespace {
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    void hashBytes(uint64_t& hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+    }
+
+    template <typename T>
+    void hashValue(uint64_t& hash, const T& value) {
+        hashBytes(hash, &value, sizeof(value));
+    }
+}
+
+uint64_t Simulation::stateHash() const {
+    uint64_t hash = FNV_OFFSET;
+    hashValue(hash, score);
+    hashValue(hash, lives);
+    hashValue(hash, hitCount);
+    hashValue(hash, totalClicks);
+    hashValue(hash, totalHitTime);
+    hashValue(hash, gameOver);
+    hashValue(hash, spawnTimer);
+    hashValue(hash, simTime);
+    hashValue(hash, nextShotTime);
+    hashValue(hash, random.getState());
+    hashValue(hash, camera.getYaw());
+    hashValue(hash, camera.getPitch());
+    hashValue(hash, static_cast<int>(fireMode));
+    for (int t = 0; t < targets.size(); t++) {
+        glm::vec3 position = targets.getPosition(t);
+        hashValue(hash, position.x);
+        hashValue(hash, position.y);
+        hashValue(hash, position.z);
+        hashValue(hash, targets.getLifeTime(t));
+        hashValue(hash, targets.getMaxLifeTime(t));
+        hashValue(hash, targets.getSkin(t));
+        hashValue(hash, targets.getSpawnTimeNs(t));
+        TargetHandle handle = targets.getHandle(t);
+        hashValue(hash, handle.index);
+        hashValue(hash, handle.generation);
+    }
+    return hash;
+}
+
+bool Simulation::rayAABBIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    const glm::vec3& boxMin, const glm::vec3& boxMax) {
+    glm::vec3 invDir = glm::vec3(1.0f) / rayDir;
+
+    glm::vec3 t0 = (boxMin - rayOrigin) * invDir;
+    glm::vec3 t1 = (boxMax - rayOrigin) * invDir;
+
+    glm::vec3 tmin = glm::min(t0, t1);
+    glm::vec3 tmax = glm::max(t0, t1);
+
+    float tNear = glm::max(glm::max(tmin.x, tmin.y), tmin.z);
+    float tFar = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
+
+    return tNear <= tFar && tFar >= 0.0f;
+}
@@ -0,0 +1,111 @@
+#include "../Header/SpawnSampler.h"
+#include "../Header/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+SpawnSampler::SpawnSampler(float halfWidth, float halfHeight, float halfDepth, float margin, float targetRadius, uint64_t seed)
+    : radius(targetRadius)
+{
+    // Its own stream: the layouts do not use up numbers from the game's generator
+    Pcg32 random(seed, 0x5a3c9e1f27d4b861ULL);
+    float minDistance = 2.0f * targetRadius * 1.02f;
+    float halfV = halfHeight - margin;
+
+    std::vector<glm::vec2> layout;
+    for (int wall = 0; wall < 4; wall++) {
+        bool alongX = wall < 2;
+        float halfU = alongX ? halfWidth - margin : halfDepth - margin;
+        for (int l = 0; l < LAYOUTS_PER_WALL; l++) {
+            layout.clear();
+            poissonDisk(halfU, halfV, minDistance, random, layout);
+            for (const glm::vec2& p : layout) {
+                switch (wall) {
+                case 0: points.push_back(glm::vec3(p.x, p.y, -halfDepth + TargetGrid::WALL_INSET)); break;
+                case 1: points.push_back(glm::vec3(p.x, p.y, halfDepth - TargetGrid::WALL_INSET)); break;
+                case 2: points.push_back(glm::vec3(-halfWidth + TargetGrid::WALL_INSET, p.y, p.x)); break;
+                default: points.push_back(glm::vec3(halfWidth - TargetGrid::WALL_INSET, p.y, p.x)); break;
+                }
+            }
+        }
+    }
+    candidates.reserve(points.size());
+}
+
+void SpawnSampler::poissonDisk(float halfU, float halfV, float minDistance, Pcg32& random, std::vector<glm::vec2>& out) {
+    const int CANDIDATES = 30;
+    float cellSize = minDistance / std::sqrt(2.0f);
+    int columns = static_cast<int>(std::ceil(2.0f * halfU / cellSize)) + 1;
+    int rows = static_cast<int>(std::ceil(2.0f * halfV / cellSize)) + 1;
+    std::vector<int> grid(static_cast<size_t>(columns) * rows, -1);
+    std::vector<int> active;
+
+    auto cellOf = [&](const glm::vec2& p, int& column, int& row) {
+        column = static_cast<int>((p.x + halfU) / cellSize);
+        row = static_cast<int>((p.y + halfV) / cellSize);
+    };
+    auto fits = [&](const glm::vec2& p) {
+        if (std::abs(p.x) > halfU || std::abs(p.y) > halfV) return false;
+        int column, row;
+        cellOf(p, column, row);
+        for (int r = std::max(row - 2, 0); r <= std::min(row + 2, rows - 1); r++) {
+            for (int c = std::max(column - 2, 0); c <= std::min(column + 2, columns - 1); c++) {
+                int other = grid[r * columns + c];
+                if (other >= 0 && glm::length(out[other] - p) < minDistance) return false;
+            }
+        }
+        return true;
+    };
+    auto add = [&](const glm::vec2& p) {
+        int column, row;
+        cellOf(p, column, row);
+        grid[row * columns + column] = static_cast<int>(out.size());
+        active.push_back(static_cast<int>(out.size()));
+        out.push_back(p);
+    };
+
+    add(glm::vec2(random.nextSigned() * halfU, random.nextSigned() * halfV));
+    while (!active.empty()) {
+        int slot = static_cast<int>(random.nextBelow(static_cast<uint32_t>(active.size())));
+        glm::vec2 center = out[active[slot]];
+        bool placed = false;
+        for (int k = 0; k < CANDIDATES && !placed; k++) {
+            // Uniform in the annulus [minDistance, 2 minDistance)
+            float angle = random.nextFloat() * 6.2831853f;
+            float distance = minDistance * std::sqrt(1.0f + 3.0f * random.nextFloat());
+            glm::vec2 p = center + distance * glm::vec2(std::cos(angle), std::sin(angle));
+            if (fits(p)) {
+                add(p);
+                placed = true;
+            }
+        }
+        if (!placed) {
+            active[slot] = active.back();
+            active.pop_back();
+        }
+    }
+}
+
+bool SpawnSampler::sample(const Camera& camera, const TargetPool& targets, Pcg32& random, glm::vec3& position) {
+    PROFILE_ZONE("SpawnSampler::sample");
+    glm::vec3 cameraPos = camera.getPosition();
+    glm::vec3 cameraFront = camera.getFront();
+    glm::vec3 cameraRight = camera.getRight();
+    glm::vec3 cameraUp = camera.getUp();
+
+    // In the view cone targets have always spawned in, and free
+    candidates.clear();
+    for (int i = 0; i < static_cast<int>(points.size()); i++) {
+        glm::vec3 toTarget = glm::normalize(points[i] - cameraPos);
+        if (glm::dot(toTarget, cameraFront) > 0.707f
+            && std::abs(glm::dot(toTarget, cameraRight)) < 0.5f
+            && std::abs(glm::dot(toTarget, cameraUp)) < 0.4f
+            && !targets.overlaps(points[i], radius)) {
+            candidates.push_back(i);
+        }
+    }
+    if (candidates.empty()) {
+        return false;
+    }
+    position = points[candidates[random.nextBelow(static_cast<uint32_t>(candidates.size()))]];
+    return true;
+}
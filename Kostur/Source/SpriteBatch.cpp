@@ -0,0 +1,245 @@
+#include "../Header/SpriteBatch.h"
+#include "../Header/RenderState.h"
+#include "../Header/Profiler.h"
+#include "../Header/GLStats.h"
+#include "../Header/stb_image.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const int ATLAS_MAX_WIDTH = 2048;
+    const int ATLAS_GAP = 2;     // empty texels between images so linear filtering never bleeds
+    const int WHITE_SIZE = 4;    // white block sampled by colored quads
+
+    unsigned char toByte(float value) {
+        return static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+SpriteBatch::SpriteBatch(ShaderProgram* shader)
+    : shaderProgram(shader), VAO(0), VBO(0), EBO(0), atlasTexture(0),
+    atlasWidth(1), atlasHeight(1), whiteU(0.0f), whiteV(0.0f), quadCapacity(0)
+{
+    projLoc = shaderProgram->getUniformLocation("uProjection");
+    atlasLoc = shaderProgram->getUniformLocation("uAtlas");
+    std::memset(projection, 0, sizeof(projection));
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    RenderState::bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+    glEnableVertexAttribArray(2);
+
+    RenderState::bindVertexArray(0);
+
+    reserveQuads(64);
+}
+
+SpriteBatch::~SpriteBatch() {
+    for (PendingImage& image : pendingImages) {
+        stbi_image_free(image.pixels);
+    }
+    RenderState::deleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    RenderState::deleteTextures(1, &atlasTexture);
+}
+
+int SpriteBatch::addImage(const char* filePath) {
+    PendingImage image;
+    int channels;
+    image.pixels = stbi_load(filePath, &image.width, &image.height, &channels, 4);
+    if (image.pixels == NULL) {
+        std::cout << "Textura nije ucitana! Putanja texture: " << filePath << std::endl;
+        return -1;
+    }
+
+    pendingImages.push_back(image);
+    return static_cast<int>(pendingImages.size()) - 1;
+}
+
+bool SpriteBatch::buildAtlas() {
+    struct Entry {
+        int width, height;
+        const unsigned char* pixels;
+        int image;  // -1 for the white block
+        int x, y;
+    };
+
+    std::vector<unsigned char> white(WHITE_SIZE * WHITE_SIZE * 4, 255);
+    std::vector<Entry> entries;
+    entries.push_back({ WHITE_SIZE, WHITE_SIZE, white.data(), -1, 0, 0 });
+    for (size_t i = 0; i < pendingImages.size(); i++) {
+        entries.push_back({ pendingImages[i].width, pendingImages[i].height, pendingImages[i].pixels, static_cast<int>(i), 0, 0 });
+    }
+
+    int maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    atlasWidth = std::min(ATLAS_MAX_WIDTH, maxTextureSize);
+
+    // Shelf packing, tallest images first
+    std::vector<Entry*> order;
+    for (Entry& entry : entries) {
+        order.push_back(&entry);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Entry* a, const Entry* b) { return a->height > b->height; });
+
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    for (Entry* entry : order) {
+        if (entry->width > atlasWidth) {
+            std::cout << "SpriteBatch: slika je sira od atlasa (" << entry->width << " px)" << std::endl;
+            return false;
+        }
+        if (shelfX + entry->width > atlasWidth) {
+            shelfY += shelfHeight + ATLAS_GAP;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        entry->x = shelfX;
+        entry->y = shelfY;
+        shelfX += entry->width + ATLAS_GAP;
+        shelfHeight = std::max(shelfHeight, entry->height);
+    }
+    atlasHeight = shelfY + shelfHeight;
+    if (atlasHeight > maxTextureSize) {
+        std::cout << "SpriteBatch: atlas je previsok (" << atlasHeight << " px)" << std::endl;
+        return false;
+    }
+
+    // Rows are copied bottom-up, like the vertical flip in loadImageToTexture
+    std::vector<unsigned char> atlas(static_cast<size_t>(atlasWidth) * atlasHeight * 4, 0);
+    regions.assign(pendingImages.size(), Region());
+    for (const Entry& entry : entries) {
+        for (int row = 0; row < entry.height; row++) {
+            const unsigned char* src = entry.pixels + static_cast<size_t>(entry.height - 1 - row) * entry.width * 4;
+            unsigned char* dst = atlas.data() + (static_cast<size_t>(entry.y + row) * atlasWidth + entry.x) * 4;
+            std::memcpy(dst, src, static_cast<size_t>(entry.width) * 4);
+        }
+
+        // Half-texel inset keeps bilinear samples inside the image
+        Region region;
+        region.u0 = (entry.x + 0.5f) / atlasWidth;
+        region.v0 = (entry.y + 0.5f) / atlasHeight;
+        region.u1 = (entry.x + entry.width - 0.5f) / atlasWidth;
+        region.v1 = (entry.y + entry.height - 0.5f) / atlasHeight;
+
+        if (entry.image < 0) {
+            whiteU = (entry.x + WHITE_SIZE * 0.5f) / atlasWidth;
+            whiteV = (entry.y + WHITE_SIZE * 0.5f) / atlasHeight;
+        }
+        else {
+            regions[entry.image] = region;
+        }
+    }
+
+    for (PendingImage& image : pendingImages) {
+        stbi_image_free(image.pixels);
+    }
+    pendingImages.clear();
+
+    glGenTextures(1, &atlasTexture);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, atlasTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasWidth, atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.data());
+    RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+
+    std::cout << "SpriteBatch atlas: " << regions.size() << " slika, " << atlasWidth << "x" << atlasHeight << std::endl;
+    return true;
+}
+
+void SpriteBatch::setProjection(const float* ortho) {
+    std::memcpy(projection, ortho, sizeof(projection));
+}
+
+void SpriteBatch::reserveQuads(size_t quadCount) {
+    if (quadCount <= quadCapacity) {
+        return;
+    }
+    quadCapacity = std::max(quadCount, quadCapacity * 2);
+    vertices.reserve(quadCapacity * 4);
+
+    // Every quad uses the same two triangles, so the index buffer is static between growths
+    std::vector<unsigned int> indices(quadCapacity * 6);
+    for (size_t i = 0; i < quadCapacity; i++) {
+        unsigned int base = static_cast<unsigned int>(i * 4);
+        indices[i * 6 + 0] = base;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 2;
+        indices[i * 6 + 3] = base;
+        indices[i * 6 + 4] = base + 2;
+        indices[i * 6 + 5] = base + 3;
+    }
+
+    RenderState::bindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+}
+
+void SpriteBatch::pushQuad(float x, float y, float width, float height,
+                           float u0, float v0, float u1, float v1,
+                           float r, float g, float b, float alpha) {
+    reserveQuads(vertices.size() / 4 + 1);
+
+    unsigned char cr = toByte(r);
+    unsigned char cg = toByte(g);
+    unsigned char cb = toByte(b);
+    unsigned char ca = toByte(alpha);
+
+    // Screen y grows downwards, the top edge samples the top of the image (v1)
+    vertices.push_back({ x, y, u0, v1, cr, cg, cb, ca });
+    vertices.push_back({ x + width, y, u1, v1, cr, cg, cb, ca });
+    vertices.push_back({ x + width, y + height, u1, v0, cr, cg, cb, ca });
+    vertices.push_back({ x, y + height, u0, v0, cr, cg, cb, ca });
+}
+
+void SpriteBatch::drawRect(float x, float y, float width, float height, float r, float g, float b, float alpha) {
+    pushQuad(x, y, width, height, whiteU, whiteV, whiteU, whiteV, r, g, b, alpha);
+}
+
+void SpriteBatch::drawImage(int image, float x, float y, float width, float height, float alpha) {
+    if (image < 0 || image >= static_cast<int>(regions.size())) {
+        return;
+    }
+    const Region& region = regions[image];
+    pushQuad(x, y, width, height, region.u0, region.v0, region.u1, region.v1, 1.0f, 1.0f, 1.0f, alpha);
+}
+
+void SpriteBatch::flush() {
+    PROFILE_ZONE("SpriteBatch::flush");
+    if (vertices.empty()) {
+        return;
+    }
+
+    shaderProgram->use();
+    shaderProgram->setMat4(projLoc, projection);
+    shaderProgram->setInt(atlasLoc, 0);
+
+    RenderState::bindTexture(0, GL_TEXTURE_2D, atlasTexture);
+
+    // Orphan the previous contents so the upload does not wait for the last flush to finish
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, quadCapacity * 4 * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+
+    RenderState::bindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(vertices.size() / 4 * 6), GL_UNSIGNED_INT, 0);
+    GLStats::countDraw(GL_TRIANGLES, static_cast<GLsizei>(vertices.size() / 4 * 6));
+
+    vertices.clear();
+}
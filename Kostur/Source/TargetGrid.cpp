@@ -0,0 +1,75 @@
+#include "../Header/TargetGrid.h"
+
+TargetGrid::TargetGrid(float roomHalfWidth, float roomHalfHeight, float roomHalfDepth)
+    : halfHeight(roomHalfHeight), maxRadius(0.0f)
+{
+    cellsV = static_cast<int>(std::ceil(2.0f * roomHalfHeight / CELL_SIZE));
+    maxDistance = 2.0f * (roomHalfWidth + roomHalfHeight + roomHalfDepth);
+
+    // Front and back run along x, left and right along z
+    const Wall layout[WALL_COUNT] = {
+        { 2, -(roomHalfDepth - WALL_INSET), 0, roomHalfWidth, 0, 0 },
+        { 2, roomHalfDepth - WALL_INSET, 0, roomHalfWidth, 0, 0 },
+        { 0, -(roomHalfWidth - WALL_INSET), 2, roomHalfDepth, 0, 0 },
+        { 0, roomHalfWidth - WALL_INSET, 2, roomHalfDepth, 0, 0 }
+    };
+    int cellCount = 0;
+    for (int w = 0; w < WALL_COUNT; w++) {
+        walls[w] = layout[w];
+        walls[w].cellsU = static_cast<int>(std::ceil(2.0f * walls[w].halfU / CELL_SIZE));
+        walls[w].firstCell = cellCount;
+        cellCount += walls[w].cellsU * cellsV;
+    }
+    looseCell = cellCount;
+    cells.resize(cellCount + 1);
+}
+
+void TargetGrid::reserve(size_t capacity) {
+    cellOfTarget.reserve(capacity);
+    slotOfTarget.reserve(capacity);
+}
+
+void TargetGrid::clear() {
+    for (std::vector<int>& cell : cells) {
+        cell.clear();
+    }
+    cellOfTarget.clear();
+    slotOfTarget.clear();
+    maxRadius = 0.0f;
+}
+
+void TargetGrid::insert(int index, const glm::vec3& position, float radius) {
+    int cell = looseCell;
+    for (const Wall& wall : walls) {
+        if (std::abs(position[wall.normalAxis] - wall.offset) <= WALL_TOLERANCE) {
+            cell = cellAt(wall, position[wall.uAxis], position.y);
+            break;
+        }
+    }
+    maxRadius = std::max(maxRadius, radius);
+
+    cellOfTarget.push_back(cell);
+    slotOfTarget.push_back(static_cast<int>(cells[cell].size()));
+    cells[cell].push_back(index);
+}
+
+void TargetGrid::remove(int index, int last) {
+    // Out of its cell: the cell's last entry takes its slot
+    std::vector<int>& cell = cells[cellOfTarget[index]];
+    int slot = slotOfTarget[index];
+    int moved = cell.back();
+    cell[slot] = moved;
+    slotOfTarget[moved] = slot;
+    cell.pop_back();
+
+    // The pool's last target is now called index
+    if (index != last) {
+        int lastCell = cellOfTarget[last];
+        int lastSlot = slotOfTarget[last];
+        cells[lastCell][lastSlot] = index;
+        cellOfTarget[index] = lastCell;
+        slotOfTarget[index] = lastSlot;
+    }
+    cellOfTarget.pop_back();
+    slotOfTarget.pop_back();
+}
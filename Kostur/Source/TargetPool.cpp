@@ -0,0 +1,157 @@
+#include "../Header/TargetPool.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KOSTUR_SSE2 1
+#endif
+
+TargetPool::TargetPool(int capacity, float roomHalfWidth, float roomHalfHeight, float roomHalfDepth)
+    : handles(capacity), grid(roomHalfWidth, roomHalfHeight, roomHalfDepth)
+{
+    positionX.reserve(capacity);
+    positionY.reserve(capacity);
+    positionZ.reserve(capacity);
+    radii.reserve(capacity);
+    lifeTimes.reserve(capacity);
+    maxLifeTimes.reserve(capacity);
+    skins.reserve(capacity);
+    spawnTimes.reserve(capacity);
+    grid.reserve(capacity);
+    expiredMask.reserve((capacity + 63) / 64);
+}
+
+void TargetPool::clear() {
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    radii.clear();
+    lifeTimes.clear();
+    maxLifeTimes.clear();
+    skins.clear();
+    spawnTimes.clear();
+    handles.clear();
+    grid.clear();
+    expiredMask.clear();
+}
+
+TargetHandle TargetPool::add(const glm::vec3& position, float radius, float lifeTime, int skin, uint64_t spawnTimeNs) {
+    TargetHandle handle = handles.allocate();
+    if (handle.isNull()) {
+        return handle;
+    }
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    positionZ.push_back(position.z);
+    radii.push_back(radius);
+    lifeTimes.push_back(lifeTime);
+    maxLifeTimes.push_back(lifeTime);
+    skins.push_back(skin);
+    spawnTimes.push_back(spawnTimeNs);
+    grid.insert(size() - 1, position, radius);
+    if (expiredMask.size() * 64 < lifeTimes.size()) {
+        expiredMask.push_back(0);
+    }
+    return handle;
+}
+
+void TargetPool::remove(int index) {
+    int last = size() - 1;
+    handles.releaseAt(index);
+    grid.remove(index, last);
+    if (index != last) {
+        positionX[index] = positionX[last];
+        positionY[index] = positionY[last];
+        positionZ[index] = positionZ[last];
+        radii[index] = radii[last];
+        lifeTimes[index] = lifeTimes[last];
+        maxLifeTimes[index] = maxLifeTimes[last];
+        skins[index] = skins[last];
+        spawnTimes[index] = spawnTimes[last];
+
+        uint64_t lastBit = (expiredMask[last >> 6] >> (last & 63)) & 1;
+        expiredMask[index >> 6] = (expiredMask[index >> 6] & ~(1ULL << (index & 63))) | (lastBit << (index & 63));
+    }
+    expiredMask[last >> 6] &= ~(1ULL << (last & 63));
+
+    positionX.pop_back();
+    positionY.pop_back();
+    positionZ.pop_back();
+    radii.pop_back();
+    lifeTimes.pop_back();
+    maxLifeTimes.pop_back();
+    skins.pop_back();
+    spawnTimes.pop_back();
+}
+
+bool TargetPool::overlaps(const glm::vec3& position, float radius) const {
+    bool found = false;
+    grid.forEachNear(position, radius, [&](int index) {
+        float dx = positionX[index] - position.x;
+        float dy = positionY[index] - position.y;
+        float dz = positionZ[index] - position.z;
+        float reach = radii[index] + radius;
+        if (dx * dx + dy * dy + dz * dz < reach * reach) {
+            found = true;
+        }
+    });
+    return found;
+}
+
+int TargetPool::age(float deltaTime) {
+    int count = size();
+    float* life = lifeTimes.data();
+    expiredMask.assign((count + 63) / 64, 0);
+    uint64_t* mask = expiredMask.data();
+
+    // Vector subtraction rounds exactly like the scalar tail, so results do not
+    // depend on which path a target landed in
+    int i = 0;
+#if defined(__AVX2__)
+    __m256 step = _mm256_set1_ps(deltaTime);
+    __m256 zero = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        __m256 value = _mm256_sub_ps(_mm256_loadu_ps(life + i), step);
+        _mm256_storeu_ps(life + i, value);
+        uint64_t bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_cmp_ps(value, zero, _CMP_LE_OQ)));
+        mask[i >> 6] |= bits << (i & 63);
+    }
+#elif defined(KOSTUR_SSE2)
+    __m128 step = _mm_set1_ps(deltaTime);
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 value = _mm_sub_ps(_mm_loadu_ps(life + i), step);
+        _mm_storeu_ps(life + i, value);
+        uint64_t bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_cmple_ps(value, zero)));
+        mask[i >> 6] |= bits << (i & 63);
+    }
+#endif
+    for (; i < count; i++) {
+        life[i] -= deltaTime;
+        if (life[i] <= 0.0f) {
+            mask[i >> 6] |= 1ULL << (i & 63);
+        }
+    }
+
+    int expired = 0;
+    for (uint64_t word : expiredMask) {
+        for (; word != 0; word &= word - 1) {
+            expired++;
+        }
+    }
+    return expired;
+}
+
+void TargetPool::removeExpired() {
+    // Highest index first, so the target moved into a freed slot has already been checked
+    for (int w = static_cast<int>(expiredMask.size()) - 1; w >= 0; w--) {
+        while (expiredMask[w] != 0) {
+            int bit = 63;
+            while (!((expiredMask[w] >> bit) & 1)) {
+                bit--;
+            }
+            remove(w * 64 + bit);
+        }
+    }
+}
@@ -1,141 +1,298 @@
 #include "../Header/TextRenderer.h"
+#include "../Header/RenderState.h"
+#include "../Header/Profiler.h"
+#include "../Header/GLStats.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
-TextRenderer::TextRenderer(unsigned int shader, int width, int height) 
-    : shaderProgram(shader), windowWidth(width), windowHeight(height)
+namespace {
+    const int ATLAS_WIDTH = 1024;
+    const int GLYPH_GAP = 2;
+
+    unsigned char toByte(float value) {
+        return static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+TextRenderer::TextRenderer(ShaderProgram* shader, int width, int height)
+    : atlasTexture(0), shaderProgram(shader), ft(nullptr), face(nullptr),
+    windowWidth(width), windowHeight(height), quadCapacity(0), layoutClock(0)
 {
-    if (FT_Init_FreeType(&ft)) {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-        return;
+    std::memset(Characters, 0, sizeof(Characters));
+    for (TextLayout& layout : layouts) {
+        layout.length = -1;
+        layout.lastUsed = 0;
     }
 
+    projLoc = shaderProgram->getUniformLocation("uProjection");
+    atlasLoc = shaderProgram->getUniformLocation("text");
+
+    float ortho[16] = {
+        2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
+        0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        -1.0f, 1.0f, 0.0f, 1.0f
+    };
+    std::copy(ortho, ortho + 16, projection);
+
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    glGenBuffers(1, &EBO);
+    RenderState::bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+    RenderState::bindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+
+    reserveQuads(256);
+
+    if (FT_Init_FreeType(&ft)) {
+        ft = nullptr;
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        return;
+    }
 }
 
 TextRenderer::~TextRenderer() {
-    glDeleteVertexArrays(1, &VAO);
+    RenderState::deleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    glDeleteBuffers(1, &EBO);
+    RenderState::deleteTextures(1, &atlasTexture);
+    if (face) FT_Done_Face(face);
+    if (ft) FT_Done_FreeType(ft);
 }
 
 bool TextRenderer::loadFont(const char* fontPath, unsigned int fontSize) {
-    if (FT_New_Face(ft, fontPath, 0, &face)) {
+    if (!ft || FT_New_Face(ft, fontPath, 0, &face)) {
+        face = nullptr;
         std::cout << "ERROR::FREETYPE: Failed to load font at: " << fontPath << std::endl;
         return false;
     }
 
     FT_Set_Pixel_Sizes(face, 0, fontSize);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
+    // Rasterize every glyph first, the atlas size is known only after packing
+    struct GlyphBitmap {
+        int x, y;
+        std::vector<unsigned char> pixels;
+    };
+    GlyphBitmap bitmaps[128];
+
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
     for (unsigned char c = 0; c < 128; c++) {
         if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
             std::cout << "ERROR::FREETYPE: Failed to load Glyph: " << c << std::endl;
             continue;
         }
 
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        Character character = {
-            texture,
-            (int)face->glyph->bitmap.width,
-            (int)face->glyph->bitmap.rows,
-            face->glyph->bitmap_left,
-            face->glyph->bitmap_top,
-            (unsigned int)face->glyph->advance.x
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        int glyphWidth = static_cast<int>(bitmap.width);
+        int glyphHeight = static_cast<int>(bitmap.rows);
+
+        if (shelfX + glyphWidth > ATLAS_WIDTH) {
+            shelfY += shelfHeight + GLYPH_GAP;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+
+        GlyphBitmap& glyph = bitmaps[c];
+        glyph.x = shelfX;
+        glyph.y = shelfY;
+        glyph.pixels.resize(static_cast<size_t>(glyphWidth) * glyphHeight);
+        for (int row = 0; row < glyphHeight; row++) {
+            std::memcpy(glyph.pixels.data() + static_cast<size_t>(row) * glyphWidth,
+                bitmap.buffer + row * bitmap.pitch, glyphWidth);
+        }
+
+        Character& character = Characters[c];
+        character.SizeX = glyphWidth;
+        character.SizeY = glyphHeight;
+        character.BearingX = face->glyph->bitmap_left;
+        character.BearingY = face->glyph->bitmap_top;
+        character.Advance = static_cast<unsigned int>(face->glyph->advance.x);
+
+        shelfX += glyphWidth + GLYPH_GAP;
+        shelfHeight = std::max(shelfHeight, glyphHeight);
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
 
-    std::cout << "FreeType font loaded successfully: " << fontPath << std::endl;
+    int atlasHeight = std::max(shelfY + shelfHeight, 1);
+    std::vector<unsigned char> atlas(static_cast<size_t>(ATLAS_WIDTH) * atlasHeight, 0);
+    for (int c = 0; c < 128; c++) {
+        Character& character = Characters[c];
+        const GlyphBitmap& glyph = bitmaps[c];
+        for (int row = 0; row < character.SizeY; row++) {
+            std::memcpy(atlas.data() + static_cast<size_t>(glyph.y + row) * ATLAS_WIDTH + glyph.x,
+                glyph.pixels.data() + static_cast<size_t>(row) * character.SizeX, character.SizeX);
+        }
+        character.U0 = static_cast<float>(glyph.x) / ATLAS_WIDTH;
+        character.V0 = static_cast<float>(glyph.y) / atlasHeight;
+        character.U1 = static_cast<float>(glyph.x + character.SizeX) / ATLAS_WIDTH;
+        character.V1 = static_cast<float>(glyph.y + character.SizeY) / atlasHeight;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &atlasTexture);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+
+    std::cout << "FreeType font loaded successfully: " << fontPath << " (atlas " << ATLAS_WIDTH << "x" << atlasHeight << ")" << std::endl;
     return true;
 }
 
-void TextRenderer::renderText(const std::string& text, float x, float y, float scale, float r, float g, float b, float alpha) {
-    glUseProgram(shaderProgram);
-    
-    float projection[16] = {
-        2.0f / windowWidth, 0.0f, 0.0f, 0.0f,
-        0.0f, -2.0f / windowHeight, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        -1.0f, 1.0f, 0.0f, 1.0f
-    };
-    
-    int projLoc = glGetUniformLocation(shaderProgram, "uProjection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, projection);
-    
-    int colorLoc = glGetUniformLocation(shaderProgram, "uTextColor");
-    glUniform3f(colorLoc, r, g, b);
-    
-    int alphaLoc = glGetUniformLocation(shaderProgram, "uAlpha");
-    glUniform1f(alphaLoc, alpha);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
-
-    for (char c : text) {
-        Character ch = Characters[c];
-
-        float xpos = x + ch.BearingX * scale;
-        float ypos = y + (ch.SizeY - ch.BearingY) * scale;
-
-        float w = ch.SizeX * scale;
-        float h = ch.SizeY * scale;
-
-        float vertices[6][4] = {
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos,     ypos - h,   0.0f, 0.0f },
-            { xpos + w, ypos - h,   1.0f, 0.0f },
-
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos - h,   1.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f }
-        };
-
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+void TextRenderer::reserveQuads(size_t quadCount) {
+    if (quadCount <= quadCapacity) {
+        return;
+    }
+    quadCapacity = std::max(quadCount, quadCapacity * 2);
+    vertices.reserve(quadCapacity * 4);
 
-        x += (ch.Advance >> 6) * scale;
+    std::vector<unsigned int> indices(quadCapacity * 6);
+    for (size_t i = 0; i < quadCapacity; i++) {
+        unsigned int base = static_cast<unsigned int>(i * 4);
+        indices[i * 6 + 0] = base;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 2;
+        indices[i * 6 + 3] = base;
+        indices[i * 6 + 4] = base + 2;
+        indices[i * 6 + 5] = base + 3;
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+
+    RenderState::bindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
 }
 
-float TextRenderer::getTextWidth(const std::string& text, float scale) {
+float TextRenderer::measure(const char* text, int length, float scale) const {
     float width = 0;
-    for (char c : text) {
-        Character ch = Characters[c];
-        width += (ch.Advance >> 6) * scale;
+    for (int i = 0; i < length; i++) {
+        width += (Characters[static_cast<unsigned char>(text[i])].Advance >> 6) * scale;
     }
     return width;
 }
+
+int TextRenderer::buildQuads(const char* text, int length, float x, float y, float scale, const unsigned char color[4], Vertex* out) const {
+    int quadCount = 0;
+    for (int i = 0; i < length; i++) {
+        const Character& ch = Characters[static_cast<unsigned char>(text[i])];
+
+        if (ch.SizeX > 0 && ch.SizeY > 0) {
+            float xpos = x + ch.BearingX * scale;
+            float ypos = y + (ch.SizeY - ch.BearingY) * scale;
+
+            float w = ch.SizeX * scale;
+            float h = ch.SizeY * scale;
+
+            // FreeType rows run top-down, so the glyph top sits at V0
+            Vertex* quad = out + quadCount * 4;
+            quad[0] = { xpos,     ypos,     ch.U0, ch.V1, color[0], color[1], color[2], color[3] };
+            quad[1] = { xpos,     ypos - h, ch.U0, ch.V0, color[0], color[1], color[2], color[3] };
+            quad[2] = { xpos + w, ypos - h, ch.U1, ch.V0, color[0], color[1], color[2], color[3] };
+            quad[3] = { xpos + w, ypos,     ch.U1, ch.V1, color[0], color[1], color[2], color[3] };
+            quadCount++;
+        }
+
+        x += (ch.Advance >> 6) * scale;
+    }
+    return quadCount;
+}
+
+const TextRenderer::TextLayout& TextRenderer::acquireLayout(const char* text, int length, float x, float y, float scale,
+                                                            TextAlign align, const unsigned char color[4]) {
+    layoutClock++;
+
+    TextLayout* oldest = &layouts[0];
+    for (TextLayout& layout : layouts) {
+        if (layout.length == length && layout.x == x && layout.y == y && layout.scale == scale && layout.align == align &&
+            std::memcmp(layout.color, color, 4) == 0 && std::memcmp(layout.text, text, length) == 0) {
+            layout.lastUsed = layoutClock;
+            return layout;
+        }
+        if (layout.lastUsed < oldest->lastUsed) {
+            oldest = &layout;
+        }
+    }
+
+    TextLayout& layout = *oldest;
+    std::memcpy(layout.text, text, length);
+    std::memcpy(layout.color, color, 4);
+    layout.length = length;
+    layout.x = x;
+    layout.y = y;
+    layout.scale = scale;
+    layout.align = align;
+    layout.width = measure(text, length, scale);
+    float left = (align == TextAlign::Center) ? x - layout.width / 2.0f : x;
+    layout.quadCount = buildQuads(text, length, left, y, scale, color, layout.quads);
+    layout.lastUsed = layoutClock;
+    return layout;
+}
+
+void TextRenderer::drawText(const char* text, int length, float x, float y, float scale, float r, float g, float b,
+                            float alpha, TextAlign align) {
+    PROFILE_ZONE("TextRenderer::drawText");
+    unsigned char color[4] = { toByte(r), toByte(g), toByte(b), toByte(alpha) };
+
+    if (length > MAX_LAYOUT_CHARS) {
+        // Too long to cache, lay it out directly into the batch
+        if (align == TextAlign::Center) {
+            x -= measure(text, length, scale) / 2.0f;
+        }
+        reserveQuads(vertices.size() / 4 + length);
+        size_t first = vertices.size();
+        vertices.resize(first + static_cast<size_t>(length) * 4);
+        int quadCount = buildQuads(text, length, x, y, scale, color, vertices.data() + first);
+        vertices.resize(first + static_cast<size_t>(quadCount) * 4);
+        return;
+    }
+
+    const TextLayout& layout = acquireLayout(text, length, x, y, scale, align, color);
+    reserveQuads(vertices.size() / 4 + layout.quadCount);
+    vertices.insert(vertices.end(), layout.quads, layout.quads + layout.quadCount * 4);
+}
+
+void TextRenderer::renderText(const std::string& text, float x, float y, float scale, float r, float g, float b, float alpha) {
+    drawText(text.data(), static_cast<int>(text.size()), x, y, scale, r, g, b, alpha);
+}
+
+void TextRenderer::flush() {
+    PROFILE_ZONE("TextRenderer::flush");
+    if (vertices.empty() || atlasTexture == 0) {
+        vertices.clear();
+        return;
+    }
+
+    shaderProgram->use();
+    shaderProgram->setMat4(projLoc, projection);
+    shaderProgram->setInt(atlasLoc, 0);
+
+    RenderState::bindTexture(0, GL_TEXTURE_2D, atlasTexture);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, quadCapacity * 4 * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    RenderState::bindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(vertices.size() / 4 * 6), GL_UNSIGNED_INT, 0);
+    GLStats::countDraw(GL_TRIANGLES, static_cast<GLsizei>(vertices.size() / 4 * 6));
+
+    vertices.clear();
+}
+
+float TextRenderer::getTextWidth(const std::string& text, float scale) {
+    return measure(text.data(), static_cast<int>(text.size()), scale);
+}
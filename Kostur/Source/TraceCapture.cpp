@@ -0,0 +1,163 @@
+#include "../Header/TraceCapture.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    const int GPU_TRACK = 100;
+    const int FRAME_TRACK = 101;
+
+    double toMicroseconds(uint64_t ns, uint64_t baseNs) {
+        return (static_cast<double>(ns) - static_cast<double>(baseNs)) / 1000.0;
+    }
+
+    void separate(FILE* file, bool& first) {
+        std::fprintf(file, first ? "\n" : ",\n");
+        first = false;
+    }
+
+    void writeThreadName(FILE* file, bool& first, int tid, const char* name) {
+        separate(file, first);
+        std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", tid, name);
+    }
+}
+
+TraceCapture::TraceCapture()
+    : state(State::Idle), framesLeft(0), drainFramesLeft(0), startNs(0), gpuToCpuNs(0), gpuProfiler(nullptr)
+{
+}
+
+TraceCapture::~TraceCapture() {
+    stopSinks();
+}
+
+void TraceCapture::start(const std::string& outputPath, int frames, GpuProfiler* profiler) {
+    if (state != State::Idle || frames <= 0) {
+        return;
+    }
+    path = outputPath;
+    framesLeft = frames;
+    gpuProfiler = profiler;
+
+    cpuEvents.clear();
+    gpuSegments.clear();
+    inputEvents.clear();
+    frameEnds.clear();
+    // Reserved up front so recording does not allocate in the common case
+    cpuEvents.reserve(static_cast<size_t>(frames) * 64);
+    gpuSegments.reserve(static_cast<size_t>(frames + GpuProfiler::FRAMES_IN_FLIGHT + 1) * 16);
+    inputEvents.reserve(static_cast<size_t>(frames) * 16);
+    frameEnds.reserve(frames);
+
+    // GL_TIMESTAMP read without waiting on the GPU; good to well under a frame
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    startNs = Profiler::nowNs();
+    gpuToCpuNs = static_cast<int64_t>(startNs) - gpuNow;
+
+    Profiler::setEventSink(&cpuEvents);
+    if (gpuProfiler) {
+        gpuProfiler->setSegmentSink(&gpuSegments);
+    }
+    state = State::Recording;
+    std::cout << "Snimanje trace-a: " << frames << " frejmova" << std::endl;
+}
+
+void TraceCapture::stopSinks() {
+    if (state == State::Idle) {
+        return;
+    }
+    Profiler::setEventSink(nullptr);
+    if (gpuProfiler) {
+        gpuProfiler->setSegmentSink(nullptr);
+    }
+}
+
+void TraceCapture::endFrame() {
+    if (state == State::Recording) {
+        frameEnds.push_back(Profiler::nowNs());
+        if (--framesLeft == 0) {
+            Profiler::setEventSink(nullptr);
+            drainFramesLeft = GpuProfiler::FRAMES_IN_FLIGHT + 1;
+            state = State::Draining;
+        }
+    }
+    else if (state == State::Draining && --drainFramesLeft == 0) {
+        finish();
+    }
+}
+
+void TraceCapture::finish() {
+    if (state == State::Idle) {
+        return;
+    }
+    stopSinks();
+    state = State::Idle;
+    if (write()) {
+        std::cout << "Trace upisan: " << path << std::endl;
+    }
+}
+
+bool TraceCapture::write() const {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cout << "Trace nije upisan: " << path << std::endl;
+        return false;
+    }
+
+    // The first drained frame started before start() was called
+    uint64_t baseNs = startNs;
+    int threadCount = 1;
+    for (const Profiler::ThreadEvent& threadEvent : cpuEvents) {
+        baseNs = std::min(baseNs, threadEvent.event.startNs);
+        threadCount = std::max(threadCount, threadEvent.thread + 1);
+    }
+    uint64_t endNs = frameEnds.empty() ? startNs : frameEnds.back();
+
+    bool first = true;
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    writeThreadName(file, first, 0, "main");
+    for (int thread = 1; thread < threadCount; thread++) {
+        char name[24];
+        std::snprintf(name, sizeof(name), "thread %d", thread);
+        writeThreadName(file, first, thread, name);
+    }
+    writeThreadName(file, first, GPU_TRACK, "GPU");
+    writeThreadName(file, first, FRAME_TRACK, "frames");
+
+    for (size_t i = 0; i < frameEnds.size(); i++) {
+        uint64_t frameStart = i == 0 ? baseNs : frameEnds[i - 1];
+        separate(file, first);
+        std::fprintf(file, "{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"index\":%zu}}",
+            FRAME_TRACK, toMicroseconds(frameStart, baseNs), (frameEnds[i] - frameStart) / 1000.0, i);
+    }
+
+    for (const Profiler::ThreadEvent& threadEvent : cpuEvents) {
+        const Profiler::Event& event = threadEvent.event;
+        separate(file, first);
+        std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            event.name, threadEvent.thread, toMicroseconds(event.startNs, baseNs), (event.endNs - event.startNs) / 1000.0);
+    }
+
+    for (const GpuProfiler::Segment& segment : gpuSegments) {
+        uint64_t segmentStart = static_cast<uint64_t>(static_cast<int64_t>(segment.startNs) + gpuToCpuNs);
+        // Frames read back while draining, or rendered before the capture started
+        if (segmentStart < baseNs || segmentStart > endNs) {
+            continue;
+        }
+        separate(file, first);
+        std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            GpuProfiler::zoneName(segment.zone), GPU_TRACK, toMicroseconds(segmentStart, baseNs),
+            (segment.endNs - segment.startNs) / 1000.0);
+    }
+
+    for (const InputEvent& input : inputEvents) {
+        separate(file, first);
+        std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"args\":{\"x\":%.2f,\"y\":%.2f}}",
+            input.name, toMicroseconds(input.timeNs, baseNs), input.x, input.y);
+    }
+
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+    return true;
+}
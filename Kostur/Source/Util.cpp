@@ -1,9 +1,11 @@
 #include "../Header/Util.h";
+#include "../Header/RenderState.h"
 
 #define _CRT_SECURE_NO_WARNINGS
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "../Header/stb_image.h"
@@ -76,14 +78,15 @@ unsigned int createShader(const char* vsSource, const char* fsSource)
     glAttachShader(program, fragmentShader);
 
     glLinkProgram(program); //Povezi ih u jedan objekat sejder programa
-    glValidateProgram(program); //Izvrsi provjeru novopecenog programa
 
+    // Provjerava se samo linkovanje: glValidateProgram gleda trenutno GL stanje (npr. sampleri
+    // razlicitih tipova na istoj jedinici prije nego sto im se dodijele jedinice) pa lazno javlja gresku
     int success;
     char infoLog[512];
-    glGetProgramiv(program, GL_VALIDATE_STATUS, &success); //Slicno kao za sejdere
+    glGetProgramiv(program, GL_LINK_STATUS, &success); //Slicno kao za sejdere
     if (success == GL_FALSE)
     {
-        glGetShaderInfoLog(program, 512, NULL, infoLog);
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
         std::cout << "Objedinjeni sejder ima gresku! Greska: \n";
         std::cout << infoLog << std::endl;
     }
@@ -119,7 +122,7 @@ unsigned loadImageToTexture(const char* filePath) {
 
         unsigned int Texture;
         glGenTextures(1, &Texture);
-        glBindTexture(GL_TEXTURE_2D, Texture);
+        RenderState::bindTexture(0, GL_TEXTURE_2D, Texture);
         
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -127,7 +130,7 @@ unsigned loadImageToTexture(const char* filePath) {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         
         glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, TextureWidth, TextureHeight, 0, InternalFormat, GL_UNSIGNED_BYTE, ImageData);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
         // oslobadjanje memorije zauzete sa stbi_load posto vise nije potrebna
         stbi_image_free(ImageData);
         return Texture;
@@ -138,4 +141,78 @@ unsigned loadImageToTexture(const char* filePath) {
         stbi_image_free(ImageData);
         return 0;
     }
-}
\ No newline at end of file
+}
+
+// Loads several images into one GL_TEXTURE_2D_ARRAY, one layer per image in the given order.
+// Layers share a size, so every image is bilinearly resampled to the largest width/height.
+unsigned loadImagesToTextureArray(const std::vector<std::string>& filePaths) {
+    struct Image {
+        int width;
+        int height;
+        unsigned char* data;
+    };
+
+    std::vector<Image> images;
+    int layerWidth = 1;
+    int layerHeight = 1;
+    for (const std::string& path : filePaths) {
+        Image image;
+        int channels;
+        image.data = stbi_load(path.c_str(), &image.width, &image.height, &channels, 4);
+        if (image.data == NULL) {
+            std::cout << "Textura nije ucitana! Putanja texture: " << path << std::endl;
+            for (Image& loaded : images) {
+                stbi_image_free(loaded.data);
+            }
+            return 0;
+        }
+        stbi__vertical_flip(image.data, image.width, image.height, 4);
+        layerWidth = std::max(layerWidth, image.width);
+        layerHeight = std::max(layerHeight, image.height);
+        images.push_back(image);
+    }
+
+    unsigned int Texture;
+    glGenTextures(1, &Texture);
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, Texture);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, layerWidth, layerHeight, static_cast<GLsizei>(images.size()),
+        0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    std::vector<unsigned char> layer(static_cast<size_t>(layerWidth) * layerHeight * 4);
+    for (size_t i = 0; i < images.size(); i++) {
+        const Image& image = images[i];
+        const unsigned char* pixels = image.data;
+        if (image.width != layerWidth || image.height != layerHeight) {
+            for (int y = 0; y < layerHeight; y++) {
+                float sy = std::max(0.0f, (y + 0.5f) * image.height / layerHeight - 0.5f);
+                int y0 = std::min(static_cast<int>(sy), image.height - 1);
+                int y1 = std::min(y0 + 1, image.height - 1);
+                float fy = sy - y0;
+                for (int x = 0; x < layerWidth; x++) {
+                    float sx = std::max(0.0f, (x + 0.5f) * image.width / layerWidth - 0.5f);
+                    int x0 = std::min(static_cast<int>(sx), image.width - 1);
+                    int x1 = std::min(x0 + 1, image.width - 1);
+                    float fx = sx - x0;
+                    for (int c = 0; c < 4; c++) {
+                        float top = pixels[(y0 * image.width + x0) * 4 + c] * (1.0f - fx) + pixels[(y0 * image.width + x1) * 4 + c] * fx;
+                        float bottom = pixels[(y1 * image.width + x0) * 4 + c] * (1.0f - fx) + pixels[(y1 * image.width + x1) * 4 + c] * fx;
+                        layer[(static_cast<size_t>(y) * layerWidth + x) * 4 + c] = static_cast<unsigned char>(top * (1.0f - fy) + bottom * fy + 0.5f);
+                    }
+                }
+            }
+            pixels = layer.data();
+        }
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(i), layerWidth, layerHeight, 1,
+            GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        stbi_image_free(image.data);
+    }
+
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    return Texture;
+}